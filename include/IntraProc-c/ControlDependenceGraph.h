@@ -0,0 +1,112 @@
+/*===- IntraProc-c/ControlDependenceGraph.h ---------------------*- C -*-===*\
+|*                                                                            *|
+|*                      Static Program Analysis for LLVM                      *|
+|*                                                                            *|
+|* This file is distributed under a Modified BSD License (see LICENSE.TXT).   *|
+|*                                                                            *|
+|*===----------------------------------------------------------------------===*|
+|*                                                                            *|
+|* This header declares the C interface to control dependence graphs. A graph *|
+|* built through it is frozen: its nodes and edges are exposed as flat arrays *|
+|* that stay valid, and unchanged, until the graph is disposed of, so callers *|
+|* in other languages can read them in place.                                 *|
+|*                                                                            *|
+\*===----------------------------------------------------------------------===*/
+
+#ifndef INTRAPROC_C_CONTROLDEPENDENCEGRAPH_H
+#define INTRAPROC_C_CONTROLDEPENDENCEGRAPH_H
+
+#include "llvm-c/Core.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+typedef struct LLVMOpaqueControlDependenceGraph *LLVMControlDependenceGraphRef;
+
+typedef enum {
+  LLVMCDNodeBlock,
+  LLVMCDNodeRegion
+} LLVMCDNodeKind;
+
+typedef enum {
+  LLVMCDEdgeTrue,
+  LLVMCDEdgeFalse,
+  LLVMCDEdgeOther
+} LLVMCDEdgeLabel;
+
+/* Construction options, passed as a bitwise or. */
+enum {
+  LLVMCDPruneInfeasibleEdges = 1 << 0,
+  LLVMCDHashRegions = 1 << 1
+};
+
+/**
+ * A graph in compressed sparse row form. Nodes are numbered by ID, root
+ * first; the edges out of node i are those from EdgeOffsets[i] up to
+ * EdgeOffsets[i+1], true edges first, then false, then other, each in ID
+ * order of their targets. BlockIndices[i] is the position of the block of
+ * node i in its function, or -1 for a region. Hashes is NULL unless the
+ * graph was built with LLVMCDHashRegions.
+ */
+typedef struct {
+  uint32_t NumNodes;
+  uint32_t NumEdges;
+  const uint8_t *NodeKinds;
+  const int32_t *BlockIndices;
+  const uint32_t *EdgeOffsets;
+  const uint32_t *EdgeTargets;
+  const uint8_t *EdgeLabels;
+  const uint64_t *Hashes;
+} LLVMCDGraphView;
+
+/**
+ * Build the control dependence graph of Fn. Flags is a combination of the
+ * construction options above; time is limited to TimeBudgetMS milliseconds
+ * and the memory construction allocates to MemoryBudget bytes, zero meaning
+ * no limit.
+ */
+LLVMControlDependenceGraphRef
+LLVMCreateControlDependenceGraph(LLVMValueRef Fn, unsigned Flags,
+                                 unsigned TimeBudgetMS, size_t MemoryBudget);
+void LLVMDisposeControlDependenceGraph(LLVMControlDependenceGraphRef G);
+
+/** Fill View with arrays owned by G. */
+void LLVMGetControlDependenceGraphView(LLVMControlDependenceGraphRef G,
+                                       LLVMCDGraphView *View);
+
+/** Was construction cut short by a budget? */
+LLVMBool LLVMIsControlDependenceGraphApproximate(LLVMControlDependenceGraphRef G);
+
+/** Return the ID of the node of BB, or -1 if BB is not in the graph. */
+int32_t LLVMGetControlDependenceNode(LLVMControlDependenceGraphRef G,
+                                     LLVMBasicBlockRef BB);
+
+/** Return the block of the node with ID Node, or NULL for a region or for
+ *  an ID that is not below the number of nodes. */
+LLVMBasicBlockRef LLVMGetControlDependenceNodeBlock(LLVMControlDependenceGraphRef G,
+                                                    uint32_t Node);
+
+/** Returned by LLVMGetEnclosingControlDependenceRegion for a block that is
+ *  not in the graph. */
+#define LLVMCDNoRegion 0xFFFFFFFFu
+
+/**
+ * Return the ID of the region enclosing BB, which is 0, the root, for the
+ * blocks that execute whenever the function does, or LLVMCDNoRegion if BB is
+ * not in the graph.
+ */
+uint32_t LLVMGetEnclosingControlDependenceRegion(LLVMControlDependenceGraphRef G,
+                                                 LLVMBasicBlockRef BB);
+
+/** Does A directly control B, or does A influence B transitively? */
+LLVMBool LLVMControlDependenceControls(LLVMControlDependenceGraphRef G,
+                                       LLVMBasicBlockRef A, LLVMBasicBlockRef B);
+LLVMBool LLVMControlDependenceInfluences(LLVMControlDependenceGraphRef G,
+                                         LLVMBasicBlockRef A, LLVMBasicBlockRef B);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* INTRAPROC_C_CONTROLDEPENDENCEGRAPH_H */
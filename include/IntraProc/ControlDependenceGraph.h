@@ -15,223 +15,329 @@
 #ifndef ANALYSIS_CONTROLDEPENDENCEGRAPH_H
 #define ANALYSIS_CONTROLDEPENDENCEGRAPH_H
 
-#include "llvm/ADT/DepthFirstIterator.h"
-#include "llvm/ADT/GraphTraits.h"
+#include "IntraProc/GenericControlDependenceGraph.h"
+#include "IntraProc/PostDominatorBuilder.h"
+#include "llvm/ADT/ArrayRef.h"
+#include "llvm/ADT/BitVector.h"
 #include "llvm/Analysis/PostDominators.h"
+#include "llvm/IR/CFG.h"
 #include "llvm/IR/Module.h"
 #include "llvm/Pass.h"
 #include "llvm/Support/DOTGraphTraits.h"
+#include "llvm/Support/Mutex.h"
 
 #include <map>
 #include <set>
-#include <iterator>
+#include <vector>
 
 namespace llvm {
 
 class BasicBlock;
 class ControlDependenceGraphBase;
+class ControlDependenceRegions;
+class LazyValueInfo;
+class LoopInfo;
+
+/// Knobs controlling how a ControlDependenceGraphBase is constructed.
+struct ControlDependenceOptions {
+  /// Ignore CFG edges that no execution can take: the untaken successors of
+  /// branches and switches on constant conditions, and every edge out of a
+  /// block that is unreachable from the entry block along feasible edges.
+  bool PruneInfeasibleEdges;
+
+  /// Per-function limits on construction time, in milliseconds, and on the
+  /// memory construction allocates, in bytes; zero means unlimited. The
+  /// memory is that of the construction's own arrays, nodes and edges, not
+  /// of the whole process. A function that exceeds either gets an
+  /// approximate graph instead (see ControlDependenceGraphBase::isApproximate).
+  unsigned TimeBudgetMS;
+  size_t MemoryBudget;
+
+  /// Collapse every top-level loop into a single node before computing
+  /// control dependences. Loops can then be expanded one at a time with
+  /// ControlDependenceGraphBase::expandLoop.
+  bool CollapseLoops;
+
+  /// Compute a Merkle hash for every node once the graph is built (see
+  /// ControlDependenceGraphBase::getHash).
+  bool HashRegions;
+
+  /// The cheapest ControlDependenceGraphBase::ConstructionTier that may be
+  /// used. Every tier builds the same graph, so raising this only serves to
+  /// check the tiers against each other.
+  unsigned MinTier;
+
+  ControlDependenceOptions()
+    : PruneInfeasibleEdges(false), TimeBudgetMS(0), MemoryBudget(0),
+      CollapseLoops(false), HashRegions(false), MinTier(0) {}
+
+  /// The options given by the -cdg-* command line flags.
+  static ControlDependenceOptions fromCommandLine();
+};
+
+/// A node of the control dependence graph of a function.
+///
+/// ControlDependenceNode used to be a class of its own, and is now an alias
+/// of the node template shared with MachineControlDependenceGraph. This is a
+/// source incompatible change for clients that forward-declare it: a
+/// declaration of "class ControlDependenceNode;" no longer compiles, and
+/// such clients must include this header, or GenericControlDependenceGraph.h
+/// and declare the same typedef, instead.
+typedef ControlDependenceNodeBase<BasicBlock> ControlDependenceNode;
+
+/// IR blocks: the successors of a conditional branch are its true and false
+/// edges.
+template <> struct ControlDependenceLabels<BasicBlock> {
+  ControlDependenceEdge::EdgeType getEdgeType(const BasicBlock *A, const BasicBlock *B) const;
+};
 
-class ControlDependenceNode {
+/// Receives notice of changes to a ControlDependenceGraphBase, so that
+/// results cached per node or region can be invalidated selectively rather
+/// than flushed whenever a graph is rebuilt.
+class ControlDependenceObserver {
 public:
-  enum EdgeType { TRUE, FALSE, OTHER };
-  typedef std::set<ControlDependenceNode *>::iterator       node_iterator;
-  typedef std::set<ControlDependenceNode *>::const_iterator const_node_iterator;
-
-  struct edge_iterator {
-    typedef node_iterator::value_type      value_type;
-    typedef node_iterator::difference_type difference_type;
-    typedef node_iterator::reference       reference;
-    typedef node_iterator::pointer         pointer;
-    typedef std::input_iterator_tag        iterator_category;
-
-    edge_iterator(ControlDependenceNode *n) : 
-      node(n), stage(TRUE), it(n->TrueChildren.begin()), end(n->TrueChildren.end()) {
-      while ((stage != OTHER) && (it == end)) this->operator++();
-    }
-    edge_iterator(ControlDependenceNode *n, EdgeType t, node_iterator i, node_iterator e) :
-      node(n), stage(t), it(i), end(e) {
-      while ((stage != OTHER) && (it == end)) this->operator++();
-    }
-    EdgeType type() const { return stage; }
-    bool operator==(edge_iterator const &other) const { 
-      return (this->stage == other.stage) && (this->it == other.it);
-    }
-    bool operator!=(edge_iterator const &other) const { return !(*this == other); }
-    reference operator*()  { return *this->it; }
-    pointer   operator->() { return &*this->it; }
-    edge_iterator& operator++() {
-      if (it != end) ++it;
-      while ((stage != OTHER) && (it == end)) {
-	if (stage == TRUE) {
-	  it = node->FalseChildren.begin();
-	  end = node->FalseChildren.end();
-	  stage = FALSE;
-	} else {
-	  it = node->OtherChildren.begin();
-	  end = node->OtherChildren.end();
-	  stage = OTHER;
-	}
-      }
-      return *this;
-    }
-    edge_iterator operator++(int) {
-      edge_iterator ret(*this);
-      assert(ret.stage == OTHER || ret.it != ret.end);
-      this->operator++();
-      return ret;
-    }
-  private:
-    ControlDependenceNode *node;
-    EdgeType stage;
-    node_iterator it, end;
-  };
+  virtual ~ControlDependenceObserver();
+
+  /// N, a block node or a region, is part of a newly built graph. Nodes are
+  /// announced in ID order once the whole graph, edges and hashes included,
+  /// is in place.
+  virtual void nodeAdded(const ControlDependenceNode *N) {}
 
-  edge_iterator begin() { return edge_iterator(this); }
-  edge_iterator end()   { return edge_iterator(this, OTHER, OtherChildren.end(), OtherChildren.end()); }
+  /// G is about to be released or rebuilt. Called before nodeRemoved.
+  virtual void graphInvalidated(const ControlDependenceGraphBase &G) {}
 
-  node_iterator true_begin()   { return TrueChildren.begin(); }
-  node_iterator true_end()     { return TrueChildren.end(); }
+  /// N is about to be deleted. Its edges, and its hash in the graph, can
+  /// still be read, so clients keyed by hash can keep results for regions
+  /// that reappear unchanged in the rebuilt graph.
+  virtual void nodeRemoved(const ControlDependenceNode *N) {}
+};
 
-  node_iterator false_begin()  { return FalseChildren.begin(); }
-  node_iterator false_end()    { return FalseChildren.end(); }
+/// A loop collapsed into a single node of a ControlDependenceGraphBase. Its
+/// blocks are copied out of LoopInfo when the graph is built, so the graph
+/// does not depend on the LoopInfo outliving it.
+class ControlDependenceLoop {
+public:
+  ControlDependenceLoop() : parent(NULL) {}
 
-  node_iterator other_begin()  { return OtherChildren.begin(); }
-  node_iterator other_end()    { return OtherChildren.end(); }
+  BasicBlock *getHeader() const { return blocks.front(); }
 
-  node_iterator parent_begin() { return Parents.begin(); }
-  node_iterator parent_end()   { return Parents.end(); }
-  const_node_iterator parent_begin() const { return Parents.begin(); }
-  const_node_iterator parent_end()   const { return Parents.end(); }
+  /// The blocks of the loop, header first, including those of nested loops.
+  const std::vector<BasicBlock *> &getBlocks() const { return blocks; }
 
-  BasicBlock *getBlock() const { return TheBB; }
-  size_t getNumParents() const { return Parents.size(); }
-  size_t getNumChildren() const { 
-    return TrueChildren.size() + FalseChildren.size() + OtherChildren.size();
-  }
-  bool isRegion() const { return TheBB == NULL; }
-  const ControlDependenceNode *enclosingRegion() const;
+  /// The loop this one is nested in, or NULL for a top-level loop.
+  const ControlDependenceLoop *getParentLoop() const { return parent; }
 
 private:
-  BasicBlock *TheBB;
-  std::set<ControlDependenceNode *> Parents;
-  std::set<ControlDependenceNode *> TrueChildren;
-  std::set<ControlDependenceNode *> FalseChildren;
-  std::set<ControlDependenceNode *> OtherChildren;
+  std::vector<BasicBlock *> blocks;
+  const ControlDependenceLoop *parent;
 
   friend class ControlDependenceGraphBase;
-
-  void clearAllChildren() {
-    TrueChildren.clear();
-    FalseChildren.clear();
-    OtherChildren.clear();
-  }
-  void clearAllParents() { Parents.clear(); }
-
-  void addTrue(ControlDependenceNode *Child);
-  void addFalse(ControlDependenceNode *Child);
-  void addOther(ControlDependenceNode *Child);
-  void addParent(ControlDependenceNode *Parent);
-  void removeTrue(ControlDependenceNode *Child);
-  void removeFalse(ControlDependenceNode *Child);
-  void removeOther(ControlDependenceNode *Child);
-  void removeParent(ControlDependenceNode *Child);
-
-  ControlDependenceNode() : TheBB(NULL) {}
-  ControlDependenceNode(BasicBlock *bb) : TheBB(bb) {}
 };
 
-template <> struct GraphTraits<ControlDependenceNode *> {
-  typedef ControlDependenceNode NodeType;
-  typedef NodeType::edge_iterator ChildIteratorType;
-
-  static NodeType *getEntryNode(NodeType *N) { return N; }
-
-  static inline ChildIteratorType child_begin(NodeType *N) {
-    return N->begin();
-  }
-  static inline ChildIteratorType child_end(NodeType *N) {
-    return N->end();
-  }
-
-  typedef df_iterator<ControlDependenceNode *> nodes_iterator;
-
-  static nodes_iterator nodes_begin(ControlDependenceNode *N) {
-    return df_begin(getEntryNode(N));
-  }
-  static nodes_iterator nodes_end(ControlDependenceNode *N) {
-    return df_end(getEntryNode(N));
-  }
-};
-  
-class ControlDependenceGraphBase {
+/// The control dependence graph of a function, built by the generic engine
+/// with pruning of infeasible edges, loop collapsing, construction budgets
+/// and tiers layered on top.
+class ControlDependenceGraphBase : public GenericControlDependenceGraph<Function *> {
 public:
-  ControlDependenceGraphBase() : root(NULL) {}
+  /// The construction strategies graphForFunction picks from by the shape
+  /// of the CFG. Straight-line functions need no post-dominators at all;
+  /// functions of fewer than 64 vertices are built in inline storage and
+  /// match region signatures as bit masks; larger ones use the full engine.
+  enum ConstructionTier { TrivialTier, SmallTier, FullTier };
+
+  ControlDependenceGraphBase()
+    : approximate(false), announced(false), tier(FullTier),
+      loopNest(NULL), ownsLoopNest(false) {}
   virtual ~ControlDependenceGraphBase() { releaseMemory(); }
   virtual void releaseMemory() {
-    for (ControlDependenceNode::node_iterator n = nodes.begin(), e = nodes.end();
-	 n != e; ++n) delete *n;
-    nodes.clear();
-    bbMap.clear();
-    root = NULL;
+    clearNodes();
+    infeasibleEdges.clear();
   }
 
-  void graphForFunction(Function &F, PostDominatorTree &pdt);
-
-  ControlDependenceNode *getRoot()             { return root; }
-  const ControlDependenceNode *getRoot() const { return root; }
-  ControlDependenceNode *operator[](const BasicBlock *BB)             { return getNode(BB); }
-  const ControlDependenceNode *operator[](const BasicBlock *BB) const { return getNode(BB); }
-  ControlDependenceNode *getNode(const BasicBlock *BB) { 
-    return bbMap[BB];
+  /// Build the graph for F, computing post-dominators with pdb. When
+  /// infeasible edge pruning is enabled and LVI is given, branch conditions
+  /// that LazyValueInfo proves constant are pruned as well as literal
+  /// constants, and the post-dominators are those of the pruned CFG. LI is
+  /// needed to collapse loops, and also lets a function that runs out of
+  /// budget fall back to a loop-collapsed graph rather than a flat one.
+  void graphForFunction(Function &F, PostDominatorBuilder &pdb,
+                        LazyValueInfo *LVI = NULL, LoopInfo *LI = NULL);
+
+  /// Summarize the regions of the graph graphForFunction would build for F
+  /// into R, without building the graph. Control dependences are gathered
+  /// in flat arrays rather than in nodes, so the peak memory is a fraction
+  /// of the graph's. This graph is left empty.
+  void regionsForFunction(Function &F, PostDominatorBuilder &pdb,
+                          ControlDependenceRegions &R,
+                          LazyValueInfo *LVI = NULL, LoopInfo *LI = NULL);
+
+  /// Build the graph for F from an existing post-dominator tree. pdt
+  /// describes the whole CFG, so when infeasible edges are pruned it is set
+  /// aside and the post-dominators of the pruned CFG are computed instead.
+  void graphForFunction(Function &F, PostDominatorTree &pdt,
+                        LazyValueInfo *LVI = NULL);
+
+  /// Report every graph built and released from now on to O. Observers are
+  /// not owned, and are inherited by the graphs of expanded loops.
+  void addObserver(ControlDependenceObserver *O) { observers.push_back(O); }
+  void removeObserver(ControlDependenceObserver *O);
+
+  void setOptions(const ControlDependenceOptions &O) { options = O; }
+  const ControlDependenceOptions &getOptions() const { return options; }
+
+  /// Return the nodes of the blocks A influences, as a set of node IDs: the
+  /// block nodes below A's node. The set is computed by one walk down from A
+  /// on first request and cached until the graph is released. The cache is
+  /// filled under a lock, so threads sharing a graph may query it at once.
+  const BitVector &controlledNodes(const BasicBlock *A) const;
+
+  /// Return the blocks A influences, in function order. The nodes of
+  /// collapsed loops contribute their headers.
+  ArrayRef<BasicBlock *> controlledBlocks(const BasicBlock *A) const;
+
+  /// Compute the Merkle hash of every node. A node's hash covers what its
+  /// block computes, or what all blocks of its collapsed loop compute: each
+  /// instruction's opcode, type, predicate, flags and other attributes, and
+  /// its operands, with constants hashed by value and values and blocks
+  /// elsewhere in the function by the position of their block. It also
+  /// covers the labels and hashes of its edges. Loops make the graph cyclic, so
+  /// only edges of a depth-first spanning tree from the root contribute a
+  /// child's full hash; any other edge contributes a hash of what the child
+  /// region's own blocks compute. A change to a block thus changes the
+  /// hashes of its region and of the regions above it, and no others.
+  void computeHashes();
+
+  /// Return the hash of N computed by computeHashes, or 0 if none was.
+  uint64_t getHash(const ControlDependenceNode *N) const {
+    return N->getID() < hashes.size() ? hashes[N->getID()] : 0;
   }
-  const ControlDependenceNode *getNode(const BasicBlock *BB) const {
-    return (bbMap.find(BB) != bbMap.end()) ? bbMap.find(BB)->second : NULL;
+
+  /// Print every node and its labelled edges in ID order, followed by the
+  /// hashes of the nodes if they were computed. The output depends only on
+  /// the function, never on allocation addresses.
+  void print(raw_ostream &OS) const;
+
+  /// Write the graph in DOT format, titled Title. Nodes are named by their
+  /// IDs, so the output is as stable as that of print().
+  void writeDOT(raw_ostream &OS, const std::string &Title) const;
+
+  /// Was construction cut short by a budget? An approximate graph puts every
+  /// block in a region of its own, controlled by every branch of the
+  /// function, so influences() over-approximates, no two blocks share an
+  /// enclosing region and alwaysExecutes() holds for none.
+  bool isApproximate() const { return approximate; }
+
+  /// Return the tier that built the graph.
+  ConstructionTier getTier() const { return tier; }
+
+  /// If N stands for a whole collapsed loop, return that loop. Every block of
+  /// the loop maps to N, which is labelled with the loop header.
+  const ControlDependenceLoop *getCollapsedLoop(const ControlDependenceNode *N) const;
+
+  /// Return the graph of the body of L, a loop collapsed in this graph, in
+  /// which the loops directly nested in L are collapsed in turn. The graph is
+  /// built on first request and owned by this one.
+  ControlDependenceGraphBase &expandLoop(const ControlDependenceLoop *L,
+                                         PostDominatorBuilder &pdb);
+
+  bool isFeasibleEdge(const BasicBlock *A, const BasicBlock *B) const {
+    return infeasibleEdges.empty() ||
+      infeasibleEdges.find(std::make_pair(A,B)) == infeasibleEdges.end();
   }
-  bool controls(BasicBlock *A, BasicBlock *B) const;
-  bool influences(BasicBlock *A, BasicBlock *B) const;
-  const ControlDependenceNode *enclosingRegion(BasicBlock *BB) const;
 
 private:
-  ControlDependenceNode *root;
-  std::set<ControlDependenceNode *> nodes;
-  std::map<const BasicBlock *,ControlDependenceNode *> bbMap;
-  static ControlDependenceNode::EdgeType getEdgeType(const BasicBlock *, const BasicBlock *);
-  void computeDependencies(Function &F, PostDominatorTree &pdt);
-  void insertRegions(PostDominatorTree &pdt);
+  typedef GenericControlDependenceGraph<Function *> Engine;
+  typedef std::pair<const BasicBlock *, const BasicBlock *> cfg_edge_type;
+
+  // Building or clearing the graph directly would bypass the options and
+  // the observers.
+  using Engine::recalculate;
+  using Engine::clear;
+
+  bool approximate;
+  bool announced;
+  ConstructionTier tier;
+  ControlDependenceOptions options;
+  std::vector<ControlDependenceObserver *> observers;
+  std::vector<uint64_t> hashes;
+  struct ControlledSet {
+    BitVector nodes;
+    std::vector<BasicBlock *> blocks;
+  };
+  mutable std::map<unsigned, ControlledSet> controlledSets;
+  mutable sys::Mutex controlledLock;
+  std::set<cfg_edge_type> infeasibleEdges;
+  struct LoopNest;
+  LoopNest *loopNest;
+  bool ownsLoopNest;
+  std::map<const ControlDependenceNode *, const ControlDependenceLoop *> collapsedLoops;
+  std::map<const ControlDependenceLoop *, ControlDependenceGraphBase *> expandedLoops;
+  struct BuildState;
+
+  void pruneInfeasibleEdges(Function &F, LazyValueInfo *LVI);
+  void createNodes(BuildState &S);
+  bool isStraightLine(Function &F) const;
+  void buildTrivialGraph(Function &F);
+  bool buildGraph(BuildState &S);
+  bool summarizeRegions(const Function &F, BuildState &S, ControlDependenceRegions &R,
+                        bool approximate);
+  static void summarizeApproximateRegions(const Function &F, BuildState &S,
+                                          ControlDependenceRegions &R);
+  void buildApproximateGraph(BuildState &S);
+  void graphForLoop(const ControlDependenceLoop *L, PostDominatorBuilder &pdb);
+  void retryCollapsed(ArrayRef<BasicBlock *> scope,
+                      PostDominatorBuilder &pdb, LoopInfo &LI);
+  void finishGraph();
+  void clearNodes();
+  const ControlledSet &controlledSet(const BasicBlock *A) const;
 };
 
 class ControlDependenceGraph : public FunctionPass, public ControlDependenceGraphBase {
 public:
   static char ID;
 
-  ControlDependenceGraph() : FunctionPass(ID), ControlDependenceGraphBase() {}
+  ControlDependenceGraph();
   virtual ~ControlDependenceGraph() { }
-  virtual void getAnalysisUsage(AnalysisUsage &AU) const {
-    AU.addRequired<PostDominatorTree>();
-    AU.setPreservesAll();
+  virtual void getAnalysisUsage(AnalysisUsage &AU) const;
+  virtual bool runOnFunction(Function &F);
+  virtual void releaseMemory() { ControlDependenceGraphBase::releaseMemory(); }
+  virtual void print(raw_ostream &OS, const Module *M) const {
+    ControlDependenceGraphBase::print(OS);
+  }
+
+  /// Require the analyses that the -cdg-* flags call for, and fetch them from
+  /// P, a function pass that required them. Other passes building graphs of
+  /// their own use these to honour -cdg-prune-with-lvi and loop collapsing.
+  static void addRequiredAnalyses(AnalysisUsage &AU);
+  static void getRequiredAnalyses(const Pass &P, LazyValueInfo *&LVI, LoopInfo *&LI);
+
+private:
+  PostDominatorBuilder pdb;
+};
+
+template <> struct GraphTraits<ControlDependenceGraphBase *>
+  : public GraphTraits<GenericControlDependenceGraph<Function *> *> {};
+
+template <> struct GraphTraits<Inverse<ControlDependenceGraphBase *> >
+  : public GraphTraits<Inverse<GenericControlDependenceGraph<Function *> *> > {
+  static nodes_iterator nodes_begin(Inverse<ControlDependenceGraphBase *> G) {
+    return G.Graph->begin();
   }
-  virtual bool runOnFunction(Function &F) {
-    PostDominatorTree &pdt = getAnalysis<PostDominatorTree>();
-    graphForFunction(F,pdt);
-    return false;
+  static nodes_iterator nodes_end(Inverse<ControlDependenceGraphBase *> G) {
+    return G.Graph->end();
   }
 };
 
 template <> struct GraphTraits<ControlDependenceGraph *>
-  : public GraphTraits<ControlDependenceNode *> {
-  static NodeType *getEntryNode(ControlDependenceGraph *CD) {
-    return CD->getRoot();
-  }
+  : public GraphTraits<ControlDependenceGraphBase *> {};
 
-  static nodes_iterator nodes_begin(ControlDependenceGraph *CD) {
-    if (getEntryNode(CD))
-      return df_begin(getEntryNode(CD));
-    else
-      return df_end(getEntryNode(CD));
+template <> struct GraphTraits<Inverse<ControlDependenceGraph *> >
+  : public GraphTraits<Inverse<ControlDependenceGraphBase *> > {
+  static nodes_iterator nodes_begin(Inverse<ControlDependenceGraph *> G) {
+    return G.Graph->begin();
   }
-
-  static nodes_iterator nodes_end(ControlDependenceGraph *CD) {
-    return df_end(getEntryNode(CD));
+  static nodes_iterator nodes_end(Inverse<ControlDependenceGraph *> G) {
+    return G.Graph->end();
   }
 };
 
@@ -267,31 +373,33 @@ class ControlDependenceGraphs : public ModulePass {
 public:
   static char ID;
 
-  ControlDependenceGraphs() : ModulePass(ID) {}
-  virtual ~ControlDependenceGraphs() {
-    graphs.clear();
-  }
+  ControlDependenceGraphs() : ModulePass(ID), regionsOnly(false) {}
+  virtual ~ControlDependenceGraphs();
 
-  virtual bool runOnModule(Module &M) {
-    for (Module::iterator F = M.begin(), E = M.end(); F != E; ++F) {
-      if (F->isDeclaration())
-	continue;
-      ControlDependenceGraphBase &cdg = graphs[F];
-      PostDominatorTree &pdt = getAnalysis<PostDominatorTree>(*F);
-      cdg.graphForFunction(*F,pdt);
-    }
-    return false;
-  }
+  virtual bool runOnModule(Module &M);
+  virtual void getAnalysisUsage(AnalysisUsage &AU) const;
+
+  /// Print the graph, unless only regions are kept, and the region summary
+  /// of every function defined in M.
+  virtual void print(raw_ostream &OS, const Module *M) const;
 
-  virtual void getAnalysisUsage(AnalysisUsage &AU) const {
-    AU.addRequired<PostDominatorTree>();
-    AU.setPreservesAll();
+  /// Return the graph of F. With -cdg-regions-only no graphs are kept, so
+  /// asking for one is an error.
+  ControlDependenceGraphBase &operator[](const Function *F) { return graphFor(F); }
+  ControlDependenceGraphBase &graphFor(const Function *F) {
+    assert(!regionsOnly && "Only region summaries are kept with -cdg-regions-only!");
+    return graphs[F];
   }
 
-  ControlDependenceGraphBase &operator[](const Function *F) { return graphs[F]; }
-  ControlDependenceGraphBase &graphFor(const Function *F) { return graphs[F]; }
+  /// Return the region summary of F. With -cdg-regions-only the summaries
+  /// are built directly, without graphs; otherwise the summary is made from
+  /// the graph on first request.
+  const ControlDependenceRegions &regionsFor(const Function *F);
 private:
   std::map<const Function *, ControlDependenceGraphBase> graphs;
+  std::map<const Function *, ControlDependenceRegions *> regions;
+  PostDominatorBuilder pdb;
+  bool regionsOnly;
 };
 
 } // namespace llvm
@@ -0,0 +1,67 @@
+//===- IntraProc/ControlDependenceMetrics.h ---------------------*- C++ -*-===//
+//
+//                      Static Program Analysis for LLVM
+//
+// This file is distributed under a Modified BSD License (see LICENSE.TXT).
+//
+//===----------------------------------------------------------------------===//
+//
+// This file defines the ControlDependenceMetrics pass, which derives code
+// complexity metrics from the control dependence graph of every function of
+// a module in one linear walk per graph, and writes them as CSV. Functions
+// are analyzed on several threads at once.
+//
+//===----------------------------------------------------------------------===//
+
+#ifndef ANALYSIS_CONTROLDEPENDENCEMETRICS_H
+#define ANALYSIS_CONTROLDEPENDENCEMETRICS_H
+
+#include "llvm/Pass.h"
+
+#include <vector>
+
+namespace llvm {
+
+class ControlDependenceGraphBase;
+
+class ControlDependenceMetrics : public ModulePass {
+public:
+  static char ID;
+
+  /// The metrics of one function. A decision is a block that controls
+  /// others; its fan-out is the number of its control dependence edges,
+  /// counted in buckets of 1, 2, 3-4, 5-8 and 9 or more. The nesting depth
+  /// of a block is the number of decisions on the longest path to it from
+  /// the root, not counting the back edges of loops. A control-equivalence
+  /// class is the set of blocks of one region.
+  struct Metrics {
+    const Function *F;
+    unsigned Blocks;
+    unsigned Regions;
+    unsigned Decisions;
+    unsigned MaxDepth;
+    unsigned MaxFanOut;
+    unsigned FanOut[5];
+    unsigned LargestClass;
+    bool Approximate;
+  };
+
+  ControlDependenceMetrics() : ModulePass(ID) {}
+
+  virtual bool runOnModule(Module &M);
+  virtual void releaseMemory() { metrics.clear(); }
+  virtual void getAnalysisUsage(AnalysisUsage &AU) const { AU.setPreservesAll(); }
+
+  /// Print the metrics of every function, in module order, as CSV.
+  virtual void print(raw_ostream &OS, const Module *M) const;
+
+  /// Compute the metrics of the graph G of F.
+  static Metrics compute(const Function &F, const ControlDependenceGraphBase &G);
+
+private:
+  std::vector<Metrics> metrics;
+};
+
+} // namespace llvm
+
+#endif // ANALYSIS_CONTROLDEPENDENCEMETRICS_H
@@ -0,0 +1,118 @@
+//===- IntraProc/ControlDependenceRegions.h ---------------------*- C++ -*-===//
+//
+//                      Static Program Analysis for LLVM
+//
+// This file is distributed under a Modified BSD License (see LICENSE.TXT).
+//
+//===----------------------------------------------------------------------===//
+//
+// This file defines the ControlDependenceRegions class, a compact summary of
+// a control dependence graph that keeps only its regions: the region each
+// block belongs to, the branches that control each region, and the tree the
+// regions form. It answers enclosing region queries for a fraction of the
+// memory of the full graph.
+//
+//===----------------------------------------------------------------------===//
+
+#ifndef ANALYSIS_CONTROLDEPENDENCEREGIONS_H
+#define ANALYSIS_CONTROLDEPENDENCEREGIONS_H
+
+#include "IntraProc/ControlDependenceGraph.h"
+
+#include "llvm/ADT/DenseMap.h"
+#include "llvm/ADT/SmallPtrSet.h"
+
+#include <vector>
+
+namespace llvm {
+
+class ControlDependenceRegions {
+public:
+  typedef unsigned RegionID;
+  static const RegionID NoRegion = ~0U;
+
+  /// A branch controlling a region, and the edge out of it that does so. A
+  /// NULL Branch stands for the entry of the function: the region executes
+  /// whenever the function is entered, as well as when its other controllers
+  /// say so. Loop headers are the usual case.
+  struct Controller {
+    BasicBlock *Branch;
+    ControlDependenceNode::EdgeType Type;
+  };
+  typedef std::vector<Controller>::const_iterator controller_iterator;
+
+  ControlDependenceRegions() : approximate(false) {}
+
+  /// Replace the contents with the regions of G, the graph of F. The
+  /// regions introduced to keep at most one true and one false edge per
+  /// branch are folded away, so each controller is a branch block.
+  /// Controllers are listed in function order of their branches, the entry
+  /// first and true before false before other for the same branch.
+  /// ControlDependenceGraphBase::regionsForFunction makes the same summary
+  /// without a graph.
+  void summarize(const Function &F, const ControlDependenceGraphBase &G);
+  void clear();
+
+  /// Print the blocks, parent and controllers of every region of F.
+  void print(raw_ostream &OS, const Function &F) const;
+
+  /// The region of the blocks that execute whenever the function does.
+  RegionID getRootRegion() const { return 0; }
+  unsigned getNumRegions() const { return parentRegion.size(); }
+
+  /// Return the region of BB, or NoRegion if BB was not in the graph.
+  RegionID enclosingRegion(const BasicBlock *BB) const {
+    DenseMap<const BasicBlock *, RegionID>::const_iterator R = regionOf.find(BB);
+    return R == regionOf.end() ? NoRegion : R->second;
+  }
+  bool sameRegion(const BasicBlock *A, const BasicBlock *B) const {
+    RegionID RA = enclosingRegion(A);
+    return RA != NoRegion && RA == enclosingRegion(B);
+  }
+
+  /// Does BB execute whenever the function is entered? See
+  /// ControlDependenceGraphBase::alwaysExecutes.
+  bool alwaysExecutes(const BasicBlock *BB) const {
+    return enclosingRegion(BB) == getRootRegion() && !loopBodies.count(BB);
+  }
+
+  /// Return the parent of R in the region tree, which follows controllers
+  /// breadth-first from the root: the parent holds a branch controlling R
+  /// and is as close to the root as possible. Regions nothing controls hang
+  /// off the root region, which has no parent.
+  RegionID getParentRegion(RegionID R) const { return parentRegion[R]; }
+
+  controller_iterator controller_begin(RegionID R) const {
+    return controllers.begin() + controllerBegin[R];
+  }
+  controller_iterator controller_end(RegionID R) const {
+    return controllers.begin() + controllerBegin[R+1];
+  }
+
+  /// Return the region holding C's branch; the root region for the entry.
+  RegionID controllingRegion(const Controller &C) const {
+    return C.Branch ? enclosingRegion(C.Branch) : getRootRegion();
+  }
+
+  /// Was the summarized graph approximate? Its regions then hold one block
+  /// or collapsed loop each and, as every branch may control every region,
+  /// no controllers are recorded.
+  bool isApproximate() const { return approximate; }
+
+private:
+  bool approximate;
+  DenseMap<const BasicBlock *, RegionID> regionOf;
+  std::vector<RegionID> parentRegion;
+  std::vector<unsigned> controllerBegin;
+  std::vector<Controller> controllers;
+  // Blocks of the root region inside a collapsed loop, other than its header.
+  SmallPtrSet<const BasicBlock *, 8> loopBodies;
+
+  void buildTree();
+
+  friend class ControlDependenceGraphBase;
+};
+
+} // namespace llvm
+
+#endif // ANALYSIS_CONTROLDEPENDENCEREGIONS_H
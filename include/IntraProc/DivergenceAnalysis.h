@@ -0,0 +1,84 @@
+//===- IntraProc/DivergenceAnalysis.h ---------------------------*- C++ -*-===//
+//
+//                      Static Program Analysis for LLVM
+//
+// This file is distributed under a Modified BSD License (see LICENSE.TXT).
+//
+//===----------------------------------------------------------------------===//
+//
+// This file defines the DivergenceAnalysis class, which finds the values,
+// branches and join points that differ between the threads of an SPMD
+// program, or between the lanes of a vectorized loop. Divergence spreads
+// from seed values through data dependences and, at divergent branches,
+// through the control dependence graph: every join point of a divergent
+// branch merges values that differ between the threads that took different
+// paths to it.
+//
+//===----------------------------------------------------------------------===//
+
+#ifndef ANALYSIS_DIVERGENCEANALYSIS_H
+#define ANALYSIS_DIVERGENCEANALYSIS_H
+
+#include "IntraProc/ControlDependenceGraph.h"
+
+#include "llvm/ADT/DenseSet.h"
+#include "llvm/ADT/SmallPtrSet.h"
+
+#include <vector>
+
+namespace llvm {
+
+class Loop;
+class LoopInfo;
+class Value;
+
+class DivergenceAnalysis {
+public:
+  /// Analyze the function of G. With LI, a divergent branch that lets some
+  /// threads leave a loop while others stay in it also makes the loop's exits
+  /// join points and the values that leave the loop divergent, as threads
+  /// leave it after different numbers of iterations.
+  explicit DivergenceAnalysis(ControlDependenceGraphBase &G, LoopInfo *LI = NULL)
+    : G(G), LI(LI), scope(NULL) {}
+
+  /// Treat V as differing between threads, and propagate.
+  void markDivergent(const Value *V);
+
+  /// Analyze L for outer loop vectorization: its header PHIs differ between
+  /// lanes, and values defined outside L are uniform. Call it before marking
+  /// anything else.
+  void analyzeLoop(const Loop *L);
+
+  bool isDivergent(const Value *V) const { return divergent.count(V); }
+  bool isUniform(const Value *V) const { return !isDivergent(V); }
+
+  /// Is the terminator of BB a branch on a divergent condition?
+  bool isDivergentBranch(const BasicBlock *BB) const { return divergentBranches.count(BB); }
+
+  /// Can threads that took different paths from a divergent branch meet at
+  /// BB? The PHIs of a join point are divergent.
+  bool isJoinPoint(const BasicBlock *BB) const { return joinPoints.count(BB); }
+
+  void clear();
+
+private:
+  ControlDependenceGraphBase &G;
+  LoopInfo *LI;
+  const Loop *scope;
+  DenseSet<const Value *> divergent;
+  SmallPtrSet<const BasicBlock *, 8> divergentBranches;
+  SmallPtrSet<const BasicBlock *, 8> joinPoints;
+  SmallPtrSet<const Loop *, 4> divergentExits;
+  std::vector<const Value *> worklist;
+
+  bool inScope(const BasicBlock *BB) const;
+  void push(const Value *V);
+  void propagate();
+  void branchDiverges(const BasicBlock *BB);
+  void joinAt(const BasicBlock *BB);
+  void loopExitDiverges(const Loop *L);
+};
+
+} // namespace llvm
+
+#endif // ANALYSIS_DIVERGENCEANALYSIS_H
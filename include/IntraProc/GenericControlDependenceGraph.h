@@ -0,0 +1,827 @@
+//===- IntraProc/GenericControlDependenceGraph.h ----------------*- C++ -*-===//
+//
+//                      Static Program Analysis for LLVM
+//
+// This file is distributed under a Modified BSD License (see LICENSE.TXT).
+//
+//===----------------------------------------------------------------------===//
+//
+// This file defines the control dependence engine shared by the graphs over
+// every kind of block: the node class, and GenericControlDependenceGraph,
+// which builds the graph of any graph type with GraphTraits from its
+// post-dominator tree. Edges are labelled by a policy, so the whole
+// construction is specialized at compile time for each kind of graph.
+// ControlDependenceGraphBase and MachineControlDependenceGraph are both built
+// on it.
+//
+//===----------------------------------------------------------------------===//
+
+#ifndef ANALYSIS_GENERICCONTROLDEPENDENCEGRAPH_H
+#define ANALYSIS_GENERICCONTROLDEPENDENCEGRAPH_H
+
+#include "llvm/ADT/BitVector.h"
+#include "llvm/ADT/DenseMap.h"
+#include "llvm/ADT/DepthFirstIterator.h"
+#include "llvm/ADT/GraphTraits.h"
+#include "llvm/ADT/SmallVector.h"
+
+#include <algorithm>
+#include <iterator>
+#include <map>
+#include <set>
+#include <vector>
+
+namespace llvm {
+
+template <class GraphT> class GenericControlDependenceGraph;
+
+/// The labels of control dependence edges, shared by the nodes of graphs
+/// over every kind of block.
+struct ControlDependenceEdge {
+  enum EdgeType { TRUE, FALSE, OTHER };
+};
+
+/// A node of a control dependence graph over blocks of type BlockT: a block,
+/// or a region of blocks with the same control dependences.
+template <class BlockT>
+class ControlDependenceNodeBase : public ControlDependenceEdge {
+public:
+  /// Orders nodes by ID, so that walking the edges of a node does not depend
+  /// on where the nodes happen to be allocated.
+  struct Order {
+    bool operator()(const ControlDependenceNodeBase *A,
+                    const ControlDependenceNodeBase *B) const {
+      return A->ID < B->ID;
+    }
+  };
+  typedef std::set<ControlDependenceNodeBase *, Order> node_set;
+  typedef typename node_set::iterator       node_iterator;
+  typedef typename node_set::const_iterator const_node_iterator;
+
+  struct edge_iterator {
+    typedef typename node_iterator::value_type      value_type;
+    typedef typename node_iterator::difference_type difference_type;
+    typedef typename node_iterator::reference       reference;
+    typedef typename node_iterator::pointer         pointer;
+    typedef std::input_iterator_tag        iterator_category;
+
+    edge_iterator(ControlDependenceNodeBase *n) : 
+      node(n), stage(TRUE), it(n->TrueChildren.begin()), end(n->TrueChildren.end()) {
+      while ((stage != OTHER) && (it == end)) this->operator++();
+    }
+    edge_iterator(ControlDependenceNodeBase *n, EdgeType t, node_iterator i, node_iterator e) :
+      node(n), stage(t), it(i), end(e) {
+      while ((stage != OTHER) && (it == end)) this->operator++();
+    }
+    EdgeType type() const { return stage; }
+    bool operator==(edge_iterator const &other) const { 
+      return (this->stage == other.stage) && (this->it == other.it);
+    }
+    bool operator!=(edge_iterator const &other) const { return !(*this == other); }
+    reference operator*()  { return *this->it; }
+    pointer   operator->() { return &*this->it; }
+    edge_iterator& operator++() {
+      if (it != end) ++it;
+      while ((stage != OTHER) && (it == end)) {
+	if (stage == TRUE) {
+	  it = node->FalseChildren.begin();
+	  end = node->FalseChildren.end();
+	  stage = FALSE;
+	} else {
+	  it = node->OtherChildren.begin();
+	  end = node->OtherChildren.end();
+	  stage = OTHER;
+	}
+      }
+      return *this;
+    }
+    edge_iterator operator++(int) {
+      edge_iterator ret(*this);
+      assert(ret.stage == OTHER || ret.it != ret.end);
+      this->operator++();
+      return ret;
+    }
+  private:
+    ControlDependenceNodeBase *node;
+    EdgeType stage;
+    node_iterator it, end;
+  };
+
+  edge_iterator begin() { return edge_iterator(this); }
+  edge_iterator end()   { return edge_iterator(this, OTHER, OtherChildren.end(), OtherChildren.end()); }
+
+  node_iterator true_begin()   { return TrueChildren.begin(); }
+  node_iterator true_end()     { return TrueChildren.end(); }
+
+  node_iterator false_begin()  { return FalseChildren.begin(); }
+  node_iterator false_end()    { return FalseChildren.end(); }
+
+  node_iterator other_begin()  { return OtherChildren.begin(); }
+  node_iterator other_end()    { return OtherChildren.end(); }
+
+  node_iterator parent_begin() { return Parents.begin(); }
+  node_iterator parent_end()   { return Parents.end(); }
+  const_node_iterator parent_begin() const { return Parents.begin(); }
+  const_node_iterator parent_end()   const { return Parents.end(); }
+
+  BlockT *getBlock() const { return TheBB; }
+
+  /// Return the node's ID, unique within its graph. The root is 0, the nodes
+  /// of blocks follow in function order, and regions come last in the order
+  /// they were created, so building a graph twice from the same function
+  /// numbers its nodes, and orders its edges, the same way.
+  unsigned getID() const { return ID; }
+  size_t getNumParents() const { return Parents.size(); }
+  size_t getNumChildren() const { 
+    return TrueChildren.size() + FalseChildren.size() + OtherChildren.size();
+  }
+  bool isRegion() const { return TheBB == NULL; }
+  const ControlDependenceNodeBase *enclosingRegion() const {
+    if (isRegion())
+      return this;
+    assert(Parents.size() == 1);
+    const ControlDependenceNodeBase *region = *Parents.begin();
+    assert(region->isRegion());
+    return region;
+  }
+
+private:
+  BlockT *TheBB;
+  unsigned ID;
+  node_set Parents;
+  node_set TrueChildren;
+  node_set FalseChildren;
+  node_set OtherChildren;
+
+  template <class GraphT> friend class GenericControlDependenceGraph;
+
+  void clearAllChildren() {
+    TrueChildren.clear();
+    FalseChildren.clear();
+    OtherChildren.clear();
+  }
+  void clearAllParents() { Parents.clear(); }
+
+  void addTrue(ControlDependenceNodeBase *Child)  { TrueChildren.insert(Child); }
+  void addFalse(ControlDependenceNodeBase *Child) { FalseChildren.insert(Child); }
+  void addOther(ControlDependenceNodeBase *Child) { OtherChildren.insert(Child); }
+  void addParent(ControlDependenceNodeBase *Parent) {
+    assert(std::find(Parent->begin(), Parent->end(), this) != Parent->end()
+	   && "Must be a child before adding the parent!");
+    Parents.insert(Parent);
+  }
+  void removeTrue(ControlDependenceNodeBase *Child)   { TrueChildren.erase(Child); }
+  void removeFalse(ControlDependenceNodeBase *Child)  { FalseChildren.erase(Child); }
+  void removeOther(ControlDependenceNodeBase *Child)  { OtherChildren.erase(Child); }
+  void removeParent(ControlDependenceNodeBase *Parent) { Parents.erase(Parent); }
+
+  ControlDependenceNodeBase(BlockT *bb, unsigned id) : TheBB(bb), ID(id) {}
+};
+
+
+template <class BlockT> struct GraphTraits<ControlDependenceNodeBase<BlockT> *> {
+  typedef ControlDependenceNodeBase<BlockT> NodeType;
+  typedef typename NodeType::edge_iterator ChildIteratorType;
+
+  static NodeType *getEntryNode(NodeType *N) { return N; }
+
+  static inline ChildIteratorType child_begin(NodeType *N) {
+    return N->begin();
+  }
+  static inline ChildIteratorType child_end(NodeType *N) {
+    return N->end();
+  }
+
+  typedef df_iterator<NodeType *> nodes_iterator;
+
+  static nodes_iterator nodes_begin(NodeType *N) {
+    return df_begin(getEntryNode(N));
+  }
+  static nodes_iterator nodes_end(NodeType *N) {
+    return df_end(getEntryNode(N));
+  }
+};
+
+/// Walks the parent edges of a node, in ID order of the parents, so that the
+/// generic algorithms can follow control dependences backwards in place.
+template <class BlockT>
+struct GraphTraits<Inverse<ControlDependenceNodeBase<BlockT> *> > {
+  typedef ControlDependenceNodeBase<BlockT> NodeType;
+  typedef typename NodeType::node_iterator ChildIteratorType;
+
+  static NodeType *getEntryNode(Inverse<NodeType *> G) { return G.Graph; }
+
+  static inline ChildIteratorType child_begin(NodeType *N) {
+    return N->parent_begin();
+  }
+  static inline ChildIteratorType child_end(NodeType *N) {
+    return N->parent_end();
+  }
+
+  typedef idf_iterator<NodeType *> nodes_iterator;
+
+  static nodes_iterator nodes_begin(Inverse<NodeType *> G) {
+    return idf_begin(G.Graph);
+  }
+  static nodes_iterator nodes_end(Inverse<NodeType *> G) {
+    return idf_end(G.Graph);
+  }
+};
+
+/// The edge labelling policy of GenericControlDependenceGraph for graphs whose
+/// nodes are of type BlockT. The default labels every edge OTHER; specialize
+/// it, or pass a policy object of your own to recalculate, to tell the
+/// successors of a branch apart.
+template <class BlockT> struct ControlDependenceLabels {
+  ControlDependenceEdge::EdgeType getEdgeType(const BlockT *A, const BlockT *B) const {
+    return ControlDependenceEdge::OTHER;
+  }
+};
+
+/// The control dependence graph of a GraphT, a graph type with GraphTraits
+/// whose nodes are blocks. The root is a virtual entry node; every block has
+/// a node; and blocks with the same control dependences are grouped under a
+/// region node, so that no node has more than one true or one false child.
+///
+/// recalculate builds the graph of a whole GraphT. Graphs that need more
+/// control over construction derive from this class and drive its phases
+/// themselves: they fill in a Vertices state, possibly merging blocks into
+/// one vertex or leaving edges out, and pass it to createNodes,
+/// computeDependencies and insertRegions before calling splitTrueFalseEdges.
+template <class GraphT>
+class GenericControlDependenceGraph {
+public:
+  typedef GraphTraits<GraphT> GT;
+  typedef typename GT::NodeType BlockT;
+  typedef ControlDependenceNodeBase<BlockT> NodeT;
+  typedef ControlDependenceEdge::EdgeType EdgeType;
+
+  GenericControlDependenceGraph() : root(NULL) {}
+  ~GenericControlDependenceGraph() { clear(); }
+
+  /// Build the graph for G. PDT is its post-dominator tree: any type whose
+  /// getNode(BlockT *) returns a node with getIDom() and getBlock(), as
+  /// PostDominatorTree, MachinePostDominatorTree and DominatorTreeBase do.
+  /// Labels names the edges: Labels.getEdgeType(A, B) is the EdgeType of the
+  /// edge from block A to its successor B.
+  template <class PostDomTreeT, class LabelsT>
+  void recalculate(GraphT G, PostDomTreeT &PDT, const LabelsT &Labels);
+
+  /// Build the graph for G, labelling edges by ControlDependenceLabels.
+  template <class PostDomTreeT>
+  void recalculate(GraphT G, PostDomTreeT &PDT) {
+    recalculate(G, PDT, ControlDependenceLabels<BlockT>());
+  }
+
+  /// Delete every node.
+  void clear();
+
+  /// The nodes by ID, root first (see ControlDependenceNodeBase::getID).
+  /// Iterating over them needs no traversal, and so no extra memory.
+  typedef typename std::vector<NodeT *>::const_iterator iterator;
+  iterator begin() const { return nodes.begin(); }
+  iterator end() const { return nodes.end(); }
+  unsigned getNumNodes() const { return nodes.size(); }
+  NodeT *getNodeByID(unsigned ID)             { return nodes[ID]; }
+  const NodeT *getNodeByID(unsigned ID) const { return nodes[ID]; }
+
+  NodeT *getRoot()             { return root; }
+  const NodeT *getRoot() const { return root; }
+  NodeT *operator[](const BlockT *B)             { return getNode(B); }
+  const NodeT *operator[](const BlockT *B) const { return getNode(B); }
+  NodeT *getNode(const BlockT *B)             { return blockMap.lookup(B); }
+  const NodeT *getNode(const BlockT *B) const { return blockMap.lookup(B); }
+
+  /// Queries walk the graph iteratively, with auxiliary memory bounded by
+  /// the number of nodes, so deep graphs cannot exhaust the stack.
+  bool controls(BlockT *A, BlockT *B) const;
+  bool influences(BlockT *A, BlockT *B) const;
+  const NodeT *enclosingRegion(BlockT *B) const {
+    const NodeT *N = getNode(B);
+    return N ? N->enclosingRegion() : NULL;
+  }
+
+  /// Does B execute whenever the graph is entered? These are the blocks of
+  /// the root region, which post-dominate the entry. Of the blocks that
+  /// share a vertex, only the one its node is labelled with counts.
+  bool alwaysExecutes(const BlockT *B) const {
+    const NodeT *N = getNode(B);
+    return N && N->getBlock() == B && N->enclosingRegion() == root;
+  }
+
+protected:
+  /// The graph being built, in flat form. Each vertex is a block, or a group
+  /// of blocks represented by one of them; vertices are numbered from 0, the
+  /// entry, and the virtual exit of the post-dominator tree is numbered
+  /// blocks.size(). The same numbering indexes the successors and their
+  /// labels, the immediate post-dominators, the post-dominator tree built
+  /// from them and the graph nodes. Graphs of fewer than SmallSize vertices,
+  /// the small tier, fit in inline storage.
+  ///
+  /// isSmall and exhausted are hooks: the phases call them through the
+  /// static type of the state they are given, so a state derived from this
+  /// one changes them by declaring its own.
+  struct Vertices {
+    static const unsigned SmallSize = 64;
+    typedef SmallVector<unsigned, SmallSize> vertex_vector;
+    typedef SmallDenseMap<const BlockT *, unsigned, SmallSize> index_map;
+
+    SmallVector<BlockT *, SmallSize> blocks;
+    index_map index;
+    vertex_vector succBegin, succs;
+    SmallVector<EdgeType, SmallSize> succTypes;
+    SmallVector<NodeT *, SmallSize> cdNodes;
+    vertex_vector ipdom;
+    vertex_vector childBegin, children;
+    vertex_vector dfsIn, dfsOut, postorder;
+
+    unsigned exit() const { return blocks.size(); }
+
+    /// Does A post-dominate B?
+    bool postDominates(unsigned A, unsigned B) const {
+      return dfsIn[A] <= dfsIn[B] && dfsIn[B] < dfsOut[A];
+    }
+
+    /// Is the graph built in the small tier, matching region signatures as
+    /// bit masks?
+    bool isSmall() const { return blocks.size() < SmallSize; }
+
+    /// Record a unit of work and report whether construction must give up.
+    bool exhausted() { return false; }
+
+    /// Add a vertex represented by B, map B to it, and return its number.
+    unsigned addVertex(BlockT *B) {
+      index[B] = blocks.size();
+      blocks.push_back(B);
+      return blocks.size() - 1;
+    }
+
+    /// Record the edges between vertices: call beginEdges once every vertex
+    /// has been added, addEdge for each edge, with exit() as the target of
+    /// edges leaving the graph, and endEdges to lay them out by source
+    /// vertex. A switch can send thousands of cases to a handful of blocks,
+    /// so repeats of the edge just recorded for a target are dropped;
+    /// construction is then linear in the number of distinct dependences
+    /// rather than of cases.
+    void beginEdges() {
+      lastSrc.assign(blocks.size() + 1, ~0U);
+      lastType.assign(blocks.size() + 1, ControlDependenceEdge::OTHER);
+    }
+    void addEdge(unsigned A, unsigned B, EdgeType T) {
+      if (lastSrc[B] == A && lastType[B] == T)
+	return;
+      lastSrc[B] = A;
+      lastType[B] = T;
+      edgeSrc.push_back(A);
+      edgeDst.push_back(B);
+      edgeTypes.push_back(T);
+    }
+    void endEdges();
+
+    /// Take the immediate post-dominators from PDT, as recalculate describes
+    /// it. Blocks missing from the tree cannot reach an exit; they hang off
+    /// the virtual exit.
+    template <class PostDomTreeT> void ipdomsFromTree(PostDomTreeT &PDT);
+
+    /// Build the post-dominator tree from ipdom, with the preorder intervals
+    /// that answer postDominates and the postorder that drives region
+    /// insertion.
+    void buildTree();
+
+  private:
+    vertex_vector edgeSrc, edgeDst, lastSrc;
+    SmallVector<EdgeType, SmallSize> edgeTypes, lastType;
+
+    template <class DomTreeNodeT>
+    static BlockT *idomBlock(DomTreeNodeT *N) {
+      return N && N->getIDom() ? N->getIDom()->getBlock() : NULL;
+    }
+  };
+
+  NodeT *root;
+  std::vector<NodeT *> nodes;
+  DenseMap<const BlockT *, NodeT *> blockMap;
+
+  NodeT *newNode(BlockT *B = NULL) {
+    NodeT *N = new NodeT(B, nodes.size());
+    nodes.push_back(N);
+    return N;
+  }
+  static void addChild(NodeT *Parent, NodeT *Child, EdgeType Type);
+  static void removeChild(NodeT *Parent, NodeT *Child, EdgeType Type);
+
+  /// Create the root and a node for every vertex of S, and map every block
+  /// in S.index to the node of its vertex.
+  template <class StateT> void createNodes(StateT &S);
+
+  /// Add the control dependences between the nodes of S. Returns false if
+  /// S.exhausted() says to give up, leaving the graph half built.
+  template <class StateT> bool computeDependencies(StateT &S);
+
+  /// Move every block node under the region of the nodes with the same
+  /// control dependences, creating regions as they are first needed. Returns
+  /// false if S.exhausted() says to give up.
+  template <class StateT> bool insertRegions(StateT &S);
+
+  /// Make sure that each node has at most one true and one false child.
+  void splitTrueFalseEdges();
+
+private:
+  // Graph types differ in whether their node iterators yield blocks or
+  // pointers to them.
+  static BlockT *toBlock(BlockT &B) { return &B; }
+  static BlockT *toBlock(BlockT *B) { return B; }
+};
+
+template <class GraphT> struct GraphTraits<GenericControlDependenceGraph<GraphT> *>
+  : public GraphTraits<typename GenericControlDependenceGraph<GraphT>::NodeT *> {
+  typedef GenericControlDependenceGraph<GraphT> CDGraphT;
+  typedef typename CDGraphT::NodeT NodeType;
+
+  static NodeType *getEntryNode(CDGraphT *CD) { return CD->getRoot(); }
+
+  // All nodes in ID order, including those unreachable from the root.
+  typedef typename CDGraphT::iterator nodes_iterator;
+
+  static nodes_iterator nodes_begin(CDGraphT *CD) { return CD->begin(); }
+  static nodes_iterator nodes_end(CDGraphT *CD)   { return CD->end(); }
+};
+
+/// The graph with its edges reversed. No node reaches the whole graph along
+/// parent edges, and the root reaches nothing, so there is no entry node:
+/// walks start from a node N with Inverse<NodeT *>(N), and walks over the
+/// whole graph start from each node in nodes_begin to nodes_end in turn.
+template <class GraphT>
+struct GraphTraits<Inverse<GenericControlDependenceGraph<GraphT> *> >
+  : public GraphTraits<Inverse<typename GenericControlDependenceGraph<GraphT>::NodeT *> > {
+  typedef GenericControlDependenceGraph<GraphT> CDGraphT;
+  typedef typename CDGraphT::NodeT NodeType;
+
+  typedef typename CDGraphT::iterator nodes_iterator;
+
+  static nodes_iterator nodes_begin(Inverse<CDGraphT *> G) {
+    return G.Graph->begin();
+  }
+  static nodes_iterator nodes_end(Inverse<CDGraphT *> G) {
+    return G.Graph->end();
+  }
+};
+
+template <class GraphT>
+void GenericControlDependenceGraph<GraphT>::Vertices::endEdges() {
+  succBegin.assign(blocks.size() + 1, 0);
+  for (unsigned i = 0, e = edgeSrc.size(); i != e; ++i)
+    ++succBegin[edgeSrc[i] + 1];
+  for (unsigned v = 0, e = blocks.size(); v != e; ++v)
+    succBegin[v+1] += succBegin[v];
+  succs.resize(edgeSrc.size());
+  succTypes.resize(edgeSrc.size());
+  vertex_vector fill(succBegin.begin(), succBegin.end() - 1);
+  for (unsigned i = 0, e = edgeSrc.size(); i != e; ++i) {
+    unsigned pos = fill[edgeSrc[i]]++;
+    succs[pos] = edgeDst[i];
+    succTypes[pos] = edgeTypes[i];
+  }
+  edgeSrc.clear();
+  edgeDst.clear();
+  edgeTypes.clear();
+}
+
+template <class GraphT>
+template <class PostDomTreeT>
+void GenericControlDependenceGraph<GraphT>::Vertices::ipdomsFromTree(PostDomTreeT &PDT) {
+  ipdom.assign(blocks.size() + 1, exit());
+  for (unsigned b = 0, e = blocks.size(); b != e; ++b) {
+    typename index_map::const_iterator I = index.find(idomBlock(PDT.getNode(blocks[b])));
+    if (I != index.end())
+      ipdom[b] = I->second;
+  }
+}
+
+template <class GraphT>
+void GenericControlDependenceGraph<GraphT>::Vertices::buildTree() {
+  unsigned n = blocks.size() + 1;
+
+  childBegin.assign(n + 1, 0);
+  for (unsigned b = 0; b != exit(); ++b)
+    ++childBegin[ipdom[b] + 1];
+  for (unsigned v = 0; v != n; ++v)
+    childBegin[v+1] += childBegin[v];
+  children.resize(exit());
+  vertex_vector fill(childBegin.begin(), childBegin.end() - 1);
+  for (unsigned b = 0; b != exit(); ++b)
+    children[fill[ipdom[b]]++] = b;
+
+  // fill is reused as the per-node cursor of the depth-first walk.
+  dfsIn.assign(n, 0);
+  dfsOut.assign(n, 0);
+  postorder.clear();
+  postorder.reserve(n);
+  fill.assign(childBegin.begin(), childBegin.end() - 1);
+  vertex_vector stack;
+  unsigned counter = 0;
+  stack.push_back(exit());
+  dfsIn[exit()] = counter++;
+  while (!stack.empty()) {
+    unsigned v = stack.back();
+    if (fill[v] != childBegin[v+1]) {
+      unsigned c = children[fill[v]++];
+      dfsIn[c] = counter++;
+      stack.push_back(c);
+    } else {
+      dfsOut[v] = counter;
+      postorder.push_back(v);
+      stack.pop_back();
+    }
+  }
+}
+
+template <class GraphT>
+template <class PostDomTreeT, class LabelsT>
+void GenericControlDependenceGraph<GraphT>::recalculate(GraphT G, PostDomTreeT &PDT,
+                                                        const LabelsT &Labels) {
+  clear();
+
+  // Number the blocks, entry first.
+  Vertices S;
+  BlockT *entry = GT::getEntryNode(G);
+  S.addVertex(entry);
+  for (typename GT::nodes_iterator I = GT::nodes_begin(G), E = GT::nodes_end(G); I != E; ++I)
+    if (toBlock(*I) != entry)
+      S.addVertex(toBlock(*I));
+
+  S.beginEdges();
+  for (unsigned a = 0, e = S.blocks.size(); a != e; ++a) {
+    BlockT *A = S.blocks[a];
+    for (typename GT::ChildIteratorType C = GT::child_begin(A), CE = GT::child_end(A);
+	 C != CE; ++C) {
+      typename Vertices::index_map::iterator I = S.index.find(*C);
+      S.addEdge(a, I == S.index.end() ? S.exit() : I->second, Labels.getEdgeType(A, *C));
+    }
+  }
+  S.endEdges();
+
+  S.ipdomsFromTree(PDT);
+  S.buildTree();
+  createNodes(S);
+  computeDependencies(S);
+  insertRegions(S);
+  splitTrueFalseEdges();
+}
+
+template <class GraphT>
+void GenericControlDependenceGraph<GraphT>::clear() {
+  for (typename std::vector<NodeT *>::iterator N = nodes.begin(), E = nodes.end(); N != E; ++N)
+    delete *N;
+  nodes.clear();
+  blockMap.clear();
+  root = NULL;
+}
+
+template <class GraphT>
+void GenericControlDependenceGraph<GraphT>::addChild(NodeT *Parent, NodeT *Child,
+                                                     EdgeType Type) {
+  switch (Type) {
+  case ControlDependenceEdge::TRUE:
+    Parent->addTrue(Child); break;
+  case ControlDependenceEdge::FALSE:
+    Parent->addFalse(Child); break;
+  case ControlDependenceEdge::OTHER:
+    Parent->addOther(Child); break;
+  }
+  Child->addParent(Parent);
+}
+
+template <class GraphT>
+void GenericControlDependenceGraph<GraphT>::removeChild(NodeT *Parent, NodeT *Child,
+                                                        EdgeType Type) {
+  switch (Type) {
+  case ControlDependenceEdge::TRUE:
+    Parent->removeTrue(Child); break;
+  case ControlDependenceEdge::FALSE:
+    Parent->removeFalse(Child); break;
+  case ControlDependenceEdge::OTHER:
+    Parent->removeOther(Child); break;
+  }
+  Child->removeParent(Parent);
+}
+
+template <class GraphT>
+template <class StateT>
+void GenericControlDependenceGraph<GraphT>::createNodes(StateT &S) {
+  root = newNode();
+  S.cdNodes.resize(S.blocks.size());
+  for (unsigned v = 0, e = S.blocks.size(); v != e; ++v)
+    S.cdNodes[v] = newNode(S.blocks[v]);
+  for (typename StateT::index_map::iterator I = S.index.begin(), E = S.index.end();
+       I != E; ++I)
+    blockMap[I->first] = S.cdNodes[I->second];
+}
+
+template <class GraphT>
+template <class StateT>
+bool GenericControlDependenceGraph<GraphT>::computeDependencies(StateT &S) {
+  // An edge from a to b that b does not post-dominate makes every vertex
+  // from b up to, but excluding, their nearest common post-dominator depend
+  // on a. As b is a successor of a, that is either a itself or a's immediate
+  // post-dominator, so the walks for all edges out of a climb the same path,
+  // and each stops at the first vertex that an earlier walk from a with the
+  // same label has reached. reached holds the last (vertex, label) pair to
+  // reach each vertex.
+  typename StateT::vertex_vector reached(S.blocks.size(), ~0U);
+
+  for (unsigned a = 0, e = S.blocks.size(); a != e; ++a) {
+    NodeT *AN = S.cdNodes[a];
+    for (unsigned i = S.succBegin[a], ie = S.succBegin[a+1]; i != ie; ++i) {
+      unsigned b = S.succs[i];
+      if (a != b && S.postDominates(b,a))
+	continue;
+      unsigned l = S.postDominates(a,b) ? a : S.ipdom[a];
+      EdgeType type = S.succTypes[i];
+      unsigned key = 3 * a + type;
+      if (a == l)
+	addChild(AN, AN, type);
+      for (unsigned cur = b; cur != l && cur != S.exit(); cur = S.ipdom[cur]) {
+	if (reached[cur] == key)
+	  break;
+	reached[cur] = key;
+	addChild(AN, S.cdNodes[cur], type);
+	if (S.exhausted())
+	  return false;
+      }
+    }
+  }
+
+  // ENTRY -> START
+  for (unsigned cur = 0; cur != S.exit(); cur = S.ipdom[cur])
+    addChild(root, S.cdNodes[cur], ControlDependenceEdge::OTHER);
+  return true;
+}
+
+namespace cdg_detail {
+
+// The control dependences of a node of a small graph, as one bit per parent
+// ID for each edge type. Parents of block nodes are the root or block nodes,
+// whose IDs are below Vertices::SmallSize in the small tier.
+struct SmallSignature {
+  uint64_t Parents[3];
+
+  bool operator==(const SmallSignature &O) const {
+    return Parents[0] == O.Parents[0] && Parents[1] == O.Parents[1] &&
+      Parents[2] == O.Parents[2];
+  }
+};
+
+} // end namespace cdg_detail
+
+template <class GraphT>
+template <class StateT>
+bool GenericControlDependenceGraph<GraphT>::insertRegions(StateT &S) {
+  typedef std::pair<EdgeType, NodeT *> cd_type;
+  typedef SmallVector<cd_type, 8> cd_list_type;
+  typedef std::set<cd_type> cd_set_type;
+  typedef std::map<cd_set_type, NodeT *> cd_map_type;
+  typedef cdg_detail::SmallSignature SmallSignature;
+
+  // Nodes with the same control dependences share a region. Small graphs
+  // find it by a linear search over bit mask signatures, large ones by
+  // looking up their set of dependences.
+  bool small = S.isSmall();
+  cd_map_type cdMap;
+  SmallVector<SmallSignature, 16> smallSignatures;
+  SmallVector<NodeT *, 16> smallRegions;
+  if (small) {
+    SmallSignature rootSignature = {{0, 0, uint64_t(1) << root->getID()}};
+    smallSignatures.push_back(rootSignature);
+    smallRegions.push_back(root);
+  } else {
+    cd_set_type initCDs;
+    initCDs.insert(std::make_pair(ControlDependenceEdge::OTHER, root));
+    cdMap.insert(std::make_pair(initCDs, root));
+  }
+
+  for (typename StateT::vertex_vector::iterator PO = S.postorder.begin(),
+	 END = S.postorder.end(); PO != END; ++PO) {
+    if (*PO == S.exit())
+      continue;
+    NodeT *node = S.cdNodes[*PO];
+    if (S.exhausted())
+      return false;
+
+    cd_list_type cds;
+    for (typename NodeT::node_iterator P = node->parent_begin(), E = node->parent_end();
+	 P != E; ++P) {
+      NodeT *parent = *P;
+      if (parent->TrueChildren.count(node))
+	cds.push_back(std::make_pair(ControlDependenceEdge::TRUE, parent));
+      if (parent->FalseChildren.count(node))
+	cds.push_back(std::make_pair(ControlDependenceEdge::FALSE, parent));
+      if (parent->OtherChildren.count(node))
+	cds.push_back(std::make_pair(ControlDependenceEdge::OTHER, parent));
+    }
+
+    NodeT *region = NULL;
+    bool created = false;
+    if (small) {
+      SmallSignature signature = {{0, 0, 0}};
+      for (typename cd_list_type::iterator CD = cds.begin(), CDEnd = cds.end(); CD != CDEnd; ++CD)
+	signature.Parents[CD->first] |= uint64_t(1) << CD->second->getID();
+      for (unsigned i = 0, e = smallSignatures.size(); i != e && !region; ++i)
+	if (smallSignatures[i] == signature)
+	  region = smallRegions[i];
+      if (!region) {
+	region = newNode();
+	created = true;
+	smallSignatures.push_back(signature);
+	smallRegions.push_back(region);
+      }
+    } else {
+      cd_set_type key(cds.begin(), cds.end());
+      typename cd_map_type::iterator CDEntry = cdMap.find(key);
+      if (CDEntry == cdMap.end()) {
+	region = newNode();
+	created = true;
+	cdMap.insert(std::make_pair(key, region));
+      } else {
+	region = CDEntry->second;
+      }
+    }
+
+    if (created)
+      for (typename cd_list_type::iterator CD = cds.begin(), CDEnd = cds.end(); CD != CDEnd; ++CD)
+	addChild(CD->second, region, CD->first);
+    // The region may be one of the old parents, the root, so drop them all
+    // before adding the new one.
+    for (typename cd_list_type::iterator CD = cds.begin(), CDEnd = cds.end(); CD != CDEnd; ++CD)
+      removeChild(CD->second, node, CD->first);
+    addChild(region, node, ControlDependenceEdge::OTHER);
+  }
+  return true;
+}
+
+// The loop appends regions to nodes, which need no fixing, so stop before
+// them.
+template <class GraphT>
+void GenericControlDependenceGraph<GraphT>::splitTrueFalseEdges() {
+  for (unsigned n = 0, e = nodes.size(); n != e; ++n) {
+    NodeT *node = nodes[n];
+    if (node->isRegion())
+      continue;
+    for (unsigned t = ControlDependenceEdge::TRUE; t <= ControlDependenceEdge::FALSE; ++t) {
+      typename NodeT::node_set &kids =
+	t == ControlDependenceEdge::TRUE ? node->TrueChildren : node->FalseChildren;
+      if (kids.size() <= 1)
+	continue;
+      NodeT *region = newNode();
+      while (!kids.empty()) {
+	NodeT *child = *kids.begin();
+	removeChild(node, child, (EdgeType)t);
+	addChild(region, child, ControlDependenceEdge::OTHER);
+      }
+      addChild(node, region, (EdgeType)t);
+    }
+  }
+}
+
+template <class GraphT>
+bool GenericControlDependenceGraph<GraphT>::controls(BlockT *A, BlockT *B) const {
+  const NodeT *n = getNode(B);
+  assert(n && "Block not in control dependence graph!");
+  // A loop can close a chain of single parents into a cycle, which no chain
+  // longer than the graph can avoid.
+  for (unsigned steps = 0, e = nodes.size(); steps != e && n->getNumParents() == 1; ++steps) {
+    n = *n->parent_begin();
+    if (n->getBlock() == A)
+      return true;
+  }
+  return false;
+}
+
+template <class GraphT>
+bool GenericControlDependenceGraph<GraphT>::influences(BlockT *A, BlockT *B) const {
+  const NodeT *n = getNode(B);
+  assert(n && "Block not in control dependence graph!");
+
+  // Loops make the graph cyclic, so remember what has been queued.
+  std::vector<const NodeT *> worklist;
+  BitVector visited(nodes.size());
+  worklist.push_back(n);
+  visited.set(n->getID());
+  while (!worklist.empty()) {
+    n = worklist.back();
+    worklist.pop_back();
+    for (typename NodeT::const_node_iterator P = n->parent_begin(), E = n->parent_end();
+	 P != E; ++P) {
+      if ((*P)->getBlock() == A) return true;
+      if (!visited.test((*P)->getID())) {
+	visited.set((*P)->getID());
+	worklist.push_back(*P);
+      }
+    }
+  }
+  return false;
+}
+
+} // namespace llvm
+
+#endif // ANALYSIS_GENERICCONTROLDEPENDENCEGRAPH_H
@@ -0,0 +1,75 @@
+//===- IntraProc/MachineControlDependenceGraph.h ----------------*- C++ -*-===//
+//
+//                      Static Program Analysis for LLVM
+//
+// This file is distributed under a Modified BSD License (see LICENSE.TXT).
+//
+//===----------------------------------------------------------------------===//
+//
+// This file defines the MachineControlDependenceGraph pass, the control
+// dependence graph of a MachineFunction. It is built from the function's
+// MachinePostDominatorTree by the engine ControlDependenceGraphBase is built
+// on, and has the same nodes, regions and queries; edges out of branches the
+// target can analyze are labelled true or false.
+//
+//===----------------------------------------------------------------------===//
+
+#ifndef ANALYSIS_MACHINECONTROLDEPENDENCEGRAPH_H
+#define ANALYSIS_MACHINECONTROLDEPENDENCEGRAPH_H
+
+#include "IntraProc/GenericControlDependenceGraph.h"
+#include "llvm/CodeGen/MachineFunction.h"
+#include "llvm/CodeGen/MachineFunctionPass.h"
+
+namespace llvm {
+
+class MachineBasicBlock;
+class MachinePostDominatorTree;
+class TargetInstrInfo;
+
+typedef ControlDependenceNodeBase<MachineBasicBlock> MachineControlDependenceNode;
+
+/// Labels the edges out of branches that the target can analyze.
+struct MachineBranchLabels {
+  const TargetInstrInfo *TII;
+
+  MachineBranchLabels(const TargetInstrInfo *TII = NULL) : TII(TII) {}
+  ControlDependenceEdge::EdgeType getEdgeType(MachineBasicBlock *A,
+                                              MachineBasicBlock *B) const;
+};
+
+/// Infeasible edge pruning, loop collapsing, budgets and hashing depend on IR
+/// analyses and are not offered at the machine level.
+class MachineControlDependenceGraph
+  : public MachineFunctionPass,
+    public GenericControlDependenceGraph<MachineFunction *> {
+public:
+  static char ID;
+
+  MachineControlDependenceGraph() : MachineFunctionPass(ID) {}
+
+  virtual void getAnalysisUsage(AnalysisUsage &AU) const;
+  virtual bool runOnMachineFunction(MachineFunction &MF);
+  virtual void releaseMemory() { clear(); }
+  virtual void print(raw_ostream &OS, const Module *M) const;
+
+  /// Build the graph for MF from its post-dominator tree.
+  void graphForFunction(MachineFunction &MF, MachinePostDominatorTree &pdt);
+};
+
+template <> struct GraphTraits<MachineControlDependenceGraph *>
+  : public GraphTraits<GenericControlDependenceGraph<MachineFunction *> *> {};
+
+template <> struct GraphTraits<Inverse<MachineControlDependenceGraph *> >
+  : public GraphTraits<Inverse<GenericControlDependenceGraph<MachineFunction *> *> > {
+  static nodes_iterator nodes_begin(Inverse<MachineControlDependenceGraph *> G) {
+    return G.Graph->begin();
+  }
+  static nodes_iterator nodes_end(Inverse<MachineControlDependenceGraph *> G) {
+    return G.Graph->end();
+  }
+};
+
+} // namespace llvm
+
+#endif // ANALYSIS_MACHINECONTROLDEPENDENCEGRAPH_H
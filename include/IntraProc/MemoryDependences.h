@@ -0,0 +1,77 @@
+//===- IntraProc/MemoryDependences.h ----------------------------*- C++ -*-===//
+//
+//                      Static Program Analysis for LLVM
+//
+// This file is distributed under a Modified BSD License (see LICENSE.TXT).
+//
+//===----------------------------------------------------------------------===//
+//
+// This file defines the MemoryDependences class, which attaches memory data
+// dependence edges to a control dependence graph for slicing through loads,
+// stores and calls. The edges come from MemoryDependenceAnalysis, which walks
+// back from each access to the accesses that clobber or define what it reads
+// or writes, and are computed a control dependence region at a time: a query
+// fills in the accesses of every block in the same region as its own, the
+// blocks that run exactly when it does, since slices and impact analyses
+// tend to ask about neighbouring accesses next. Regions nested in it are
+// left until they are asked about.
+//
+//===----------------------------------------------------------------------===//
+
+#ifndef ANALYSIS_MEMORYDEPENDENCES_H
+#define ANALYSIS_MEMORYDEPENDENCES_H
+
+#include "IntraProc/ControlDependenceGraph.h"
+
+#include "llvm/ADT/ArrayRef.h"
+#include "llvm/ADT/DenseMap.h"
+#include "llvm/ADT/SmallPtrSet.h"
+
+#include <vector>
+
+namespace llvm {
+
+class AliasAnalysis;
+class Instruction;
+class MemoryDependenceAnalysis;
+
+class MemoryDependences {
+public:
+  /// Attach memory dependences to G, which must be the graph of the function
+  /// MDA and AA analyze.
+  MemoryDependences(const ControlDependenceGraphBase &G, MemoryDependenceAnalysis &MDA,
+                    AliasAnalysis &AA)
+    : G(G), MDA(MDA), AA(AA) {}
+
+  /// Return the accesses I depends on through memory, in this function: the
+  /// nearest ones that write what I reads, or may. They are in program
+  /// order, by the function order of their blocks and then by their order
+  /// within a block. Instructions that do not touch memory have none.
+  ArrayRef<Instruction *> getDependences(Instruction *I);
+
+  /// Did the walks from I give up, or reach accesses they cannot name, so
+  /// that I may depend on accesses getDependences does not list?
+  bool hasUnknownDependences(Instruction *I);
+
+  /// Forget every cached edge, as when the function has been changed.
+  void clear();
+
+  void print(raw_ostream &OS, const Function &F);
+
+private:
+  const ControlDependenceGraphBase &G;
+  MemoryDependenceAnalysis &MDA;
+  AliasAnalysis &AA;
+  DenseMap<const Instruction *, std::vector<Instruction *> > dependences;
+  SmallPtrSet<const Instruction *, 8> unknown;
+  SmallPtrSet<const BasicBlock *, 16> computedBlocks;
+  DenseMap<const BasicBlock *, unsigned> blockOrder;
+
+  void computeFor(Instruction *I);
+  void computeBlock(BasicBlock *BB);
+  void computeRegion(BasicBlock *BB);
+};
+
+} // namespace llvm
+
+#endif // ANALYSIS_MEMORYDEPENDENCES_H
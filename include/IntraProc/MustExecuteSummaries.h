@@ -0,0 +1,60 @@
+//===- IntraProc/MustExecuteSummaries.h -------------------------*- C++ -*-===//
+//
+//                      Static Program Analysis for LLVM
+//
+// This file is distributed under a Modified BSD License (see LICENSE.TXT).
+//
+//===----------------------------------------------------------------------===//
+//
+// This file defines the MustExecuteSummaries pass. It records the blocks of
+// every function that execute whenever the function is entered, the blocks of
+// the root region of its control dependence graph, and propagates them
+// bottom-up over the call graph to find the functions each function always
+// calls. Calls are assumed to return.
+//
+//===----------------------------------------------------------------------===//
+
+#ifndef ANALYSIS_MUSTEXECUTESUMMARIES_H
+#define ANALYSIS_MUSTEXECUTESUMMARIES_H
+
+#include "llvm/ADT/DenseMap.h"
+#include "llvm/ADT/DenseSet.h"
+#include "llvm/Pass.h"
+
+namespace llvm {
+
+class BasicBlock;
+class Function;
+class Instruction;
+
+class MustExecuteSummaries : public ModulePass {
+public:
+  static char ID;
+
+  MustExecuteSummaries() : ModulePass(ID) {}
+
+  virtual bool runOnModule(Module &M);
+  virtual void getAnalysisUsage(AnalysisUsage &AU) const;
+  virtual void releaseMemory();
+  virtual void print(raw_ostream &OS, const Module *M) const;
+
+  /// Does BB execute whenever its function is entered?
+  bool alwaysExecutes(const BasicBlock *BB) const { return executed.count(BB); }
+
+  /// Does every call of F call G, directly or through other functions? A
+  /// function calls itself only through recursion it cannot avoid.
+  bool alwaysCalls(const Function *F, const Function *G) const;
+
+  /// Does every call of F execute I, in F or in a function it always calls?
+  bool alwaysReaches(const Function *F, const Instruction *I) const;
+
+private:
+  typedef DenseSet<const Function *> FunctionSet;
+
+  DenseSet<const BasicBlock *> executed;
+  DenseMap<const Function *, FunctionSet> callees;
+};
+
+} // namespace llvm
+
+#endif // ANALYSIS_MUSTEXECUTESUMMARIES_H
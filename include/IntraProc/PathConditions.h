@@ -0,0 +1,128 @@
+//===- IntraProc/PathConditions.h -------------------------------*- C++ -*-===//
+//
+//                      Static Program Analysis for LLVM
+//
+// This file is distributed under a Modified BSD License (see LICENSE.TXT).
+//
+//===----------------------------------------------------------------------===//
+//
+// This file defines the PathConditions class, which gives every block the
+// predicate under which it executes, built from the controllers of the
+// regions of a control dependence graph. Conditions are hash-consed into a
+// DAG: structurally equal formulas are the same object, blocks of the same
+// region share one, and each region's formula is built on those of the
+// regions controlling it, so clients can memoize on condition pointers.
+//
+//===----------------------------------------------------------------------===//
+
+#ifndef ANALYSIS_PATHCONDITIONS_H
+#define ANALYSIS_PATHCONDITIONS_H
+
+#include "IntraProc/ControlDependenceRegions.h"
+
+#include "llvm/ADT/ArrayRef.h"
+#include "llvm/ADT/FoldingSet.h"
+#include "llvm/Support/Allocator.h"
+
+#include <vector>
+
+namespace llvm {
+
+class raw_ostream;
+
+/// A node of a path condition DAG: true, a branch literal, or a conjunction
+/// or disjunction of other conditions. Literals of true and false edges stand
+/// for the branch taking that edge; an OTHER literal, from a switch or a
+/// collapsed loop, stands for the branch taking any edge into its target
+/// region.
+class PathCondition : public FoldingSetNode {
+public:
+  enum Kind { True, Literal, And, Or };
+
+  Kind getKind() const { return kind; }
+
+  /// Return the condition's number, unique within its PathConditions and in
+  /// order of creation, so operands always have smaller IDs.
+  unsigned getID() const { return ID; }
+
+  const BasicBlock *getBranch() const { return branch; }
+  ControlDependenceNode::EdgeType getEdgeType() const { return type; }
+  ControlDependenceRegions::RegionID getTarget() const { return target; }
+
+  typedef const PathCondition *const *op_iterator;
+  op_iterator op_begin() const { return ops; }
+  op_iterator op_end() const { return ops + numOps; }
+  unsigned getNumOperands() const { return numOps; }
+
+  void Profile(FoldingSetNodeID &FID) const;
+
+  /// Print the node alone, naming its operands by ID.
+  void print(raw_ostream &OS) const;
+
+private:
+  Kind kind;
+  unsigned ID;
+  const BasicBlock *branch;
+  ControlDependenceNode::EdgeType type;
+  ControlDependenceRegions::RegionID target;
+  const PathCondition **ops;
+  unsigned numOps;
+
+  friend class PathConditions;
+
+  PathCondition(Kind K, unsigned ID) : kind(K), ID(ID), branch(NULL),
+    type(ControlDependenceNode::OTHER), target(0), ops(NULL), numOps(0) {}
+};
+
+class PathConditions {
+public:
+  /// Compute the condition of every region of R. Regions are taken in the
+  /// breadth-first order of R's region tree, and a region's condition is
+  /// the disjunction, over its controllers, of the controller's literal and
+  /// the condition of the controller's region. A controller whose region
+  /// comes later in that order has no condition yet and contributes its
+  /// literal alone: loop latches, and branches nested deeper in the tree
+  /// than a region they rejoin. Conditions are thus weaker than exact path
+  /// predicates, but never rule out a path that can execute.
+  explicit PathConditions(const ControlDependenceRegions &R);
+
+  /// Return the condition under which BB executes, or NULL if BB is not in
+  /// the summarized graph.
+  const PathCondition *getCondition(const BasicBlock *BB) const;
+  const PathCondition *getRegionCondition(ControlDependenceRegions::RegionID R) const {
+    return conditions[R];
+  }
+  const PathCondition *getTrue() const { return trueCond; }
+
+  /// The uniqued constructors; they fold true away and flatten, sort and
+  /// deduplicate the operands of disjunctions. Target is ignored for true
+  /// and false edges.
+  const PathCondition *getLiteral(const BasicBlock *Branch,
+                                  ControlDependenceNode::EdgeType Type,
+                                  ControlDependenceRegions::RegionID Target);
+  const PathCondition *getAnd(const PathCondition *A, const PathCondition *B);
+  const PathCondition *getOr(ArrayRef<const PathCondition *> Ops);
+
+  unsigned getNumConditions() const { return all.size(); }
+
+  /// Print every condition once, in ID order, then the condition of every
+  /// region.
+  void print(raw_ostream &OS) const;
+
+private:
+  const ControlDependenceRegions &regions;
+  BumpPtrAllocator allocator;
+  FoldingSet<PathCondition> uniquer;
+  std::vector<const PathCondition *> all;
+  std::vector<const PathCondition *> conditions;
+  const PathCondition *trueCond;
+
+  const PathCondition *unique(PathCondition::Kind K, const BasicBlock *Branch,
+                              ControlDependenceNode::EdgeType Type,
+                              ControlDependenceRegions::RegionID Target,
+                              ArrayRef<const PathCondition *> Ops);
+};
+
+} // namespace llvm
+
+#endif // ANALYSIS_PATHCONDITIONS_H
@@ -0,0 +1,56 @@
+//===- IntraProc/PostDominatorBuilder.h -------------------------*- C++ -*-===//
+//
+//                      Static Program Analysis for LLVM
+//
+// This file is distributed under a Modified BSD License (see LICENSE.TXT).
+//
+//===----------------------------------------------------------------------===//
+//
+// This file defines the PostDominatorBuilder class, which computes immediate
+// post-dominators with the Semi-NCA algorithm of Georgiadis et al. It works on
+// a CFG given as flat successor arrays so that control dependence
+// construction can run without a PostDominatorTree from the pass manager.
+//
+//===----------------------------------------------------------------------===//
+
+#ifndef ANALYSIS_POSTDOMINATORBUILDER_H
+#define ANALYSIS_POSTDOMINATORBUILDER_H
+
+#include "llvm/ADT/ArrayRef.h"
+#include "llvm/ADT/SmallVector.h"
+
+#include <vector>
+
+namespace llvm {
+
+class PostDominatorBuilder {
+public:
+  /// Compute the immediate post-dominator of every block of a CFG with
+  /// NumBlocks blocks, where the successors of block i are
+  /// Succs[SuccBegin[i]] up to Succs[SuccBegin[i+1]]. The virtual exit is
+  /// numbered NumBlocks. It succeeds every block without successors, and may
+  /// also appear in Succs when the CFG is a subgraph that blocks can leave.
+  /// Blocks that cannot reach an exit are attached to the virtual exit as
+  /// well, latest block first, so that every block ends up in the tree.
+  ///
+  /// On return IPDom has NumBlocks+1 entries and IPDom[i] is the immediate
+  /// post-dominator of block i; the virtual exit is its own.
+  void compute(unsigned NumBlocks, ArrayRef<unsigned> SuccBegin,
+               ArrayRef<unsigned> Succs, SmallVectorImpl<unsigned> &IPDom);
+
+private:
+  // Working storage is kept between calls so that building the trees for a
+  // whole module does not reallocate for every function.
+  std::vector<unsigned> PredBegin, Preds;
+  std::vector<unsigned> Num, Vertex, Parent, Semi, Label;
+  std::vector<unsigned> WorkNode, WorkParent, EvalStack;
+  unsigned LastNum;
+
+  void runDFS(unsigned Root, unsigned ParentNum, unsigned Exit,
+              ArrayRef<unsigned> SuccBegin);
+  unsigned eval(unsigned V, unsigned LastLinked);
+};
+
+} // namespace llvm
+
+#endif // ANALYSIS_POSTDOMINATORBUILDER_H
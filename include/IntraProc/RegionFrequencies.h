@@ -0,0 +1,63 @@
+//===- IntraProc/RegionFrequencies.h ----------------------------*- C++ -*-===//
+//
+//                      Static Program Analysis for LLVM
+//
+// This file is distributed under a Modified BSD License (see LICENSE.TXT).
+//
+//===----------------------------------------------------------------------===//
+//
+// This file defines the RegionFrequencies class, a quick estimate of block
+// frequencies for triage. A block runs as often as its region, and a region
+// as often as its controllers take the edges into it, so one pass over the
+// regions in topological order, weighting each controller's frequency by the
+// probability of its edge, estimates them all.
+//
+//===----------------------------------------------------------------------===//
+
+#ifndef ANALYSIS_REGIONFREQUENCIES_H
+#define ANALYSIS_REGIONFREQUENCIES_H
+
+#include "IntraProc/ControlDependenceRegions.h"
+
+#include <vector>
+
+namespace llvm {
+
+class BranchProbabilityInfo;
+class raw_ostream;
+
+class RegionFrequencies {
+public:
+  /// Estimate the frequency of every region of R from the edge probabilities
+  /// of BPI. Regions are taken in topological order of their controller
+  /// edges. A controller on a back edge of that order, such as a loop latch,
+  /// is taken to run as often as the region itself, so a loop runs
+  /// 1 / (1 - p) times as often as it is entered, where p is the probability
+  /// of taking its back edges.
+  RegionFrequencies(const ControlDependenceRegions &R,
+                    const BranchProbabilityInfo &BPI);
+
+  /// Return the frequency of BB relative to the entry block, or 0 if BB is
+  /// not in the summarized graph.
+  double getFrequency(const BasicBlock *BB) const;
+  double getRegionFrequency(ControlDependenceRegions::RegionID R) const {
+    return frequencies[R];
+  }
+
+  /// Loops are assumed to run at most this many times per entry.
+  static const unsigned MaxLoopScale = 4096;
+
+  void print(raw_ostream &OS, const Function &F) const;
+
+private:
+  const ControlDependenceRegions &regions;
+  std::vector<double> frequencies;
+
+  double edgeProbability(const ControlDependenceRegions::Controller &C,
+                         ControlDependenceRegions::RegionID Target,
+                         const BranchProbabilityInfo &BPI) const;
+};
+
+} // namespace llvm
+
+#endif // ANALYSIS_REGIONFREQUENCIES_H
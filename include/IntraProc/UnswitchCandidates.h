@@ -0,0 +1,72 @@
+//===- IntraProc/UnswitchCandidates.h ---------------------------*- C++ -*-===//
+//
+//                      Static Program Analysis for LLVM
+//
+// This file is distributed under a Modified BSD License (see LICENSE.TXT).
+//
+//===----------------------------------------------------------------------===//
+//
+// This file defines the UnswitchCandidates pass, which lists for every loop
+// the conditional branches on loop-invariant conditions that are worth
+// unswitching. Unswitching a branch duplicates its loop, and each copy drops
+// the blocks that only the side of the branch it does not take controls; the
+// control dependence graph gives those blocks directly.
+//
+//===----------------------------------------------------------------------===//
+
+#ifndef ANALYSIS_UNSWITCHCANDIDATES_H
+#define ANALYSIS_UNSWITCHCANDIDATES_H
+
+#include "llvm/ADT/DenseMap.h"
+#include "llvm/Pass.h"
+
+#include <vector>
+
+namespace llvm {
+
+class BasicBlock;
+class ControlDependenceGraphBase;
+class Loop;
+
+class UnswitchCandidates : public FunctionPass {
+public:
+  static char ID;
+
+  struct Candidate {
+    const BasicBlock *Branch;
+    /// The blocks of the loop the branch controls, transitively, and their
+    /// instructions.
+    unsigned ControlledBlocks;
+    unsigned ControlledInsts;
+    /// The instructions controlled by one side of the branch only, which
+    /// one of the two copies of the loop drops.
+    unsigned Benefit;
+    /// The instructions unswitching adds: the copy of the loop, less what
+    /// both copies drop.
+    unsigned Growth;
+  };
+  typedef std::vector<Candidate> CandidateList;
+
+  UnswitchCandidates() : FunctionPass(ID), function(NULL) {}
+
+  virtual bool runOnFunction(Function &F);
+  virtual void getAnalysisUsage(AnalysisUsage &AU) const;
+  virtual void releaseMemory() { candidates.clear(); }
+  virtual void print(raw_ostream &OS, const Module *M) const;
+
+  /// Return the profitable candidates of L, most beneficial first: those
+  /// whose growth is within -unswitch-candidate-threshold. An approximate
+  /// control dependence graph yields none.
+  const CandidateList &getCandidates(const Loop *L) const;
+
+private:
+  const Function *function;
+  std::vector<const Loop *> loops;
+  DenseMap<const Loop *, CandidateList> candidates;
+
+  void analyzeLoop(const Loop *L, const ControlDependenceGraphBase &G);
+};
+
+} // namespace llvm
+
+#endif // ANALYSIS_UNSWITCHCANDIDATES_H
@@ -13,75 +13,193 @@
 //===----------------------------------------------------------------------===//
 
 #include "IntraProc/ControlDependenceGraph.h"
+#include "IntraProc/ControlDependenceRegions.h"
 
-#include "llvm/Analysis/DOTGraphTraitsPass.h"
+#include "llvm/Analysis/LazyValueInfo.h"
+#include "llvm/Analysis/LoopInfo.h"
+#include "llvm/ADT/DenseMap.h"
+#include "llvm/ADT/Hashing.h"
 #include "llvm/ADT/PostOrderIterator.h"
+#include "llvm/ADT/SmallPtrSet.h"
+#include "llvm/ADT/SmallVector.h"
+#include "llvm/IR/Constants.h"
 #include "llvm/IR/Function.h"
 #include "llvm/IR/CFG.h"
+#include "llvm/IR/CallSite.h"
+#include "llvm/IR/Instructions.h"
+#include "llvm/Support/CommandLine.h"
+#include "llvm/Support/ErrorHandling.h"
+#include "llvm/Support/FileSystem.h"
+#include "llvm/Support/Format.h"
+#include "llvm/Support/GraphWriter.h"
+#include "llvm/Support/ManagedStatic.h"
+#include "llvm/Support/MutexGuard.h"
+#include "llvm/Support/raw_ostream.h"
+#include "llvm/Support/TimeValue.h"
 
 
-#include <deque>
-#include <set>
+#include <algorithm>
+#include <thread>
+#include <vector>
 
 using namespace llvm;
 
-namespace llvm {
+static cl::opt<bool>
+PruneInfeasible("cdg-prune-infeasible",
+                cl::desc("Ignore CFG edges that can never be taken when "
+                         "computing control dependences"));
 
-void ControlDependenceNode::addTrue(ControlDependenceNode *Child) {
-  TrueChildren.insert(Child);
-}
+static cl::opt<bool>
+PruneWithLVI("cdg-prune-with-lvi",
+             cl::desc("Use LazyValueInfo to find constant branch conditions "
+                      "when pruning infeasible edges"));
 
-void ControlDependenceNode::addFalse(ControlDependenceNode *Child) {
-  FalseChildren.insert(Child);
-}
+static cl::opt<unsigned>
+TimeBudget("cdg-time-budget", cl::init(0), cl::value_desc("ms"),
+           cl::desc("Build an approximate control dependence graph for "
+                    "functions that take longer than this"));
 
-void ControlDependenceNode::addOther(ControlDependenceNode *Child) {
-  OtherChildren.insert(Child);
-}
+static cl::opt<unsigned>
+MemoryBudget("cdg-memory-budget", cl::init(0), cl::value_desc("MB"),
+             cl::desc("Build an approximate control dependence graph for "
+                      "functions that need more memory than this"));
 
-void ControlDependenceNode::addParent(ControlDependenceNode *Parent) {
-  assert(std::find(Parent->begin(), Parent->end(), this) != Parent->end()
-  	 && "Must be a child before adding the parent!");
-  Parents.insert(Parent);
-}
+static cl::opt<bool>
+CollapseLoops("cdg-collapse-loops",
+              cl::desc("Collapse every top-level loop into a single node of "
+                       "the control dependence graph"));
 
-void ControlDependenceNode::removeTrue(ControlDependenceNode *Child) {
-  node_iterator CN = TrueChildren.find(Child);
-  if (CN != TrueChildren.end())
-    TrueChildren.erase(CN);
-}
+static cl::opt<bool>
+RegionsOnly("cdg-regions-only",
+            cl::desc("Keep only the region structure of each function's "
+                     "control dependence graph"));
 
-void ControlDependenceNode::removeFalse(ControlDependenceNode *Child) {
-  node_iterator CN = FalseChildren.find(Child);
-  if (CN != FalseChildren.end())
-    FalseChildren.erase(CN);
-}
+static cl::opt<bool>
+HashRegions("cdg-hash-regions",
+            cl::desc("Compute a Merkle hash for every node of the control "
+                     "dependence graph"));
+
+static cl::opt<ControlDependenceGraphBase::ConstructionTier>
+MinTier("cdg-min-tier", cl::Hidden, cl::init(ControlDependenceGraphBase::TrivialTier),
+        cl::desc("Build control dependence graphs with no cheaper "
+                 "construction tier than this"),
+        cl::values(clEnumValN(ControlDependenceGraphBase::TrivialTier, "trivial",
+                              "Any tier (default)"),
+                   clEnumValN(ControlDependenceGraphBase::SmallTier, "small",
+                              "The small or full tier"),
+                   clEnumValN(ControlDependenceGraphBase::FullTier, "full",
+                              "The full tier only"),
+                   clEnumValEnd));
+
+static cl::opt<bool>
+UsePostDomTree("cdg-post-dom-tree", cl::Hidden,
+               cl::desc("Build control dependence graphs from the "
+                        "PostDominatorTree pass rather than the in-library "
+                        "post-dominator builder"));
 
-void ControlDependenceNode::removeOther(ControlDependenceNode *Child) {
-  node_iterator CN = OtherChildren.find(Child);
-  if (CN != OtherChildren.end())
-    OtherChildren.erase(CN);
+static cl::opt<std::string>
+TraceFile("cdg-trace", cl::value_desc("filename"),
+          cl::desc("Write a Chrome trace event for every control dependence "
+                   "construction phase to <filename>"));
+
+ControlDependenceOptions ControlDependenceOptions::fromCommandLine() {
+  ControlDependenceOptions Opts;
+  Opts.PruneInfeasibleEdges = PruneInfeasible || PruneWithLVI;
+  Opts.TimeBudgetMS = TimeBudget;
+  Opts.MemoryBudget = size_t(::MemoryBudget) << 20;
+  Opts.CollapseLoops = ::CollapseLoops;
+  Opts.HashRegions = ::HashRegions;
+  Opts.MinTier = ::MinTier;
+  return Opts;
 }
 
-void ControlDependenceNode::removeParent(ControlDependenceNode *Parent) {
-  node_iterator PN = Parents.find(Parent);
-  if (PN != Parents.end())
-    Parents.erase(PN);
+namespace {
+
+// Writes the events of -cdg-trace in the JSON array format of Chrome's trace
+// viewer. Functions may be analyzed on several threads at once, so each
+// event is written whole under a lock and carries a small thread number.
+class PhaseTracer {
+public:
+  PhaseTracer() : OS(NULL) {}
+  ~PhaseTracer() {
+    if (OS) {
+      *OS << "\n]\n";
+      delete OS;
+    }
+  }
+  void event(const char *Phase, const Function *F,
+             sys::TimeValue Start, sys::TimeValue End);
+
+private:
+  sys::Mutex Lock;
+  raw_fd_ostream *OS;
+  std::map<std::thread::id, unsigned> threads;
+};
+
+// Times its own lifetime as one phase of the construction for F.
+class TracePhase {
+public:
+  TracePhase(const char *Phase, const Function *F) : Phase(Phase), F(F) {
+    if (!TraceFile.empty())
+      Start = sys::TimeValue::now();
+  }
+  ~TracePhase();
+
+private:
+  const char *Phase;
+  const Function *F;
+  sys::TimeValue Start;
+};
+
+} // end anonymous namespace
+
+static ManagedStatic<PhaseTracer> Tracer;
+
+static void writeJSONString(raw_ostream &OS, StringRef S) {
+  OS << '"';
+  for (StringRef::iterator C = S.begin(), E = S.end(); C != E; ++C) {
+    if (*C == '"' || *C == '\\')
+      OS << '\\' << *C;
+    else if ((unsigned char)*C < 0x20)
+      OS << format("\\u%04x", (unsigned char)*C);
+    else
+      OS << *C;
+  }
+  OS << '"';
 }
 
-const ControlDependenceNode *ControlDependenceNode::enclosingRegion() const {
-  if (this->isRegion()) {
-    return this;
+void PhaseTracer::event(const char *Phase, const Function *F,
+                        sys::TimeValue Start, sys::TimeValue End) {
+  MutexGuard Guard(Lock);
+  if (!OS) {
+    std::string Err;
+    OS = new raw_fd_ostream(TraceFile.c_str(), Err, sys::fs::F_Text);
+    if (!Err.empty())
+      report_fatal_error(Twine("Cannot open trace file '") + TraceFile + "': " + Err);
+    *OS << "[\n";
   } else {
-    assert(this->Parents.size() == 1);
-    const ControlDependenceNode *region = *this->Parents.begin();
-    assert(region->isRegion());
-    return region;
+    *OS << ",\n";
   }
+  unsigned tid = threads.insert(std::make_pair(std::this_thread::get_id(),
+                                               (unsigned)threads.size() + 1)).first->second;
+  *OS << "{\"name\":\"" << Phase << "\",\"cat\":\"cdg\",\"ph\":\"X\",\"pid\":1"
+      << ",\"tid\":" << tid << ",\"ts\":" << Start.usec()
+      << ",\"dur\":" << (End - Start).usec() << ",\"args\":{\"function\":";
+  writeJSONString(*OS, F->getName());
+  *OS << "}}";
 }
 
-ControlDependenceNode::EdgeType
-ControlDependenceGraphBase::getEdgeType(const BasicBlock *A, const BasicBlock *B) {
+TracePhase::~TracePhase() {
+  if (!TraceFile.empty())
+    Tracer->event(Phase, F, Start, sys::TimeValue::now());
+}
+
+namespace llvm {
+
+ControlDependenceObserver::~ControlDependenceObserver() {}
+
+ControlDependenceEdge::EdgeType
+ControlDependenceLabels<BasicBlock>::getEdgeType(const BasicBlock *A, const BasicBlock *B) const {
   if (const BranchInst *b = dyn_cast<BranchInst>(A->getTerminator())) {
     if (b->isConditional()) {
       if (b->getSuccessor(0) == B) {
@@ -96,237 +214,1430 @@ ControlDependenceGraphBase::getEdgeType(const BasicBlock *A, const BasicBlock *B
   return ControlDependenceNode::OTHER;
 }
 
-void ControlDependenceGraphBase::computeDependencies(Function &F, PostDominatorTree &pdt) {
-  root = new ControlDependenceNode();
-  nodes.insert(root);
-
-  for (Function::iterator BB = F.begin(), E = F.end(); BB != E; ++BB) {
-    ControlDependenceNode *bn = new ControlDependenceNode(BB);
-    nodes.insert(bn);
-    bbMap[BB] = bn;
+// Return the constant that A's terminator switches on, if it is known.
+static ConstantInt *getConstantCondition(BasicBlock *A, LazyValueInfo *LVI) {
+  TerminatorInst *TI = A->getTerminator();
+  Value *Cond = NULL;
+  if (BranchInst *b = dyn_cast<BranchInst>(TI)) {
+    if (b->isConditional())
+      Cond = b->getCondition();
+  } else if (SwitchInst *s = dyn_cast<SwitchInst>(TI)) {
+    Cond = s->getCondition();
   }
+  if (!Cond)
+    return NULL;
+  if (ConstantInt *C = dyn_cast<ConstantInt>(Cond))
+    return C;
+  if (LVI)
+    return dyn_cast_or_null<ConstantInt>(LVI->getConstant(Cond, A));
+  return NULL;
+}
 
-  for (Function::iterator BB = F.begin(), E = F.end(); BB != E; ++BB) {
-    BasicBlock *A = BB;
-    ControlDependenceNode *AN = bbMap[A];
+// Return the only successor of A that can be taken when A's condition is C.
+static BasicBlock *getTakenSuccessor(BasicBlock *A, ConstantInt *C) {
+  TerminatorInst *TI = A->getTerminator();
+  if (BranchInst *b = dyn_cast<BranchInst>(TI))
+    return b->getSuccessor(C->isZero() ? 1 : 0);
+  return cast<SwitchInst>(TI)->findCaseValue(C).getCaseSuccessor();
+}
+
+void ControlDependenceGraphBase::pruneInfeasibleEdges(Function &F, LazyValueInfo *LVI) {
+  std::map<const BasicBlock *, BasicBlock *> taken;
+  SmallPtrSet<const BasicBlock *, 32> reachable;
+  SmallVector<BasicBlock *, 32> worklist;
 
+  reachable.insert(&F.getEntryBlock());
+  worklist.push_back(&F.getEntryBlock());
+  while (!worklist.empty()) {
+    BasicBlock *A = worklist.pop_back_val();
+    BasicBlock *only = NULL;
+    if (ConstantInt *C = getConstantCondition(A, LVI))
+      only = taken[A] = getTakenSuccessor(A, C);
     for (succ_iterator succ = succ_begin(A), end = succ_end(A); succ != end; ++succ) {
       BasicBlock *B = *succ;
-      assert(A && B);
-      if (A == B || !pdt.dominates(B,A)) {
-	BasicBlock *L = pdt.findNearestCommonDominator(A,B);
-	ControlDependenceNode::EdgeType type = ControlDependenceGraphBase::getEdgeType(A,B);
-	if (A == L) {
-	  switch (type) {
-	  case ControlDependenceNode::TRUE:
-	    AN->addTrue(AN); break;
-	  case ControlDependenceNode::FALSE:
-	    AN->addFalse(AN); break;
-	  case ControlDependenceNode::OTHER:
-	    AN->addOther(AN); break;
-	  }
-	  AN->addParent(AN);
-	}
-	for (DomTreeNode *cur = pdt[B]; cur && cur != pdt[L]; cur = cur->getIDom()) {
-	  ControlDependenceNode *CN = bbMap[cur->getBlock()];
-	  switch (type) {
-	  case ControlDependenceNode::TRUE:
-	    AN->addTrue(CN); break;
-	  case ControlDependenceNode::FALSE:
-	    AN->addFalse(CN); break;
-	  case ControlDependenceNode::OTHER:
-	    AN->addOther(CN); break;
-	  }
-	  assert(CN);
-	  CN->addParent(AN);
-	}
+      if ((!only || B == only) && !reachable.count(B)) {
+        reachable.insert(B);
+        worklist.push_back(B);
       }
     }
   }
 
-  // ENTRY -> START
-  for (DomTreeNode *cur = pdt[&F.getEntryBlock()]; cur; cur = cur->getIDom()) {
-    if (cur->getBlock()) {
-      ControlDependenceNode *CN = bbMap[cur->getBlock()];
-      assert(CN);
-      root->addOther(CN); CN->addParent(root);
+  for (Function::iterator BB = F.begin(), E = F.end(); BB != E; ++BB) {
+    BasicBlock *A = BB;
+    bool dead = !reachable.count(A);
+    std::map<const BasicBlock *, BasicBlock *>::iterator only = taken.find(A);
+    for (succ_iterator succ = succ_begin(A), end = succ_end(A); succ != end; ++succ) {
+      BasicBlock *B = *succ;
+      if (dead || (only != taken.end() && B != only->second))
+        infeasibleEdges.insert(std::make_pair(A,B));
     }
   }
 }
 
-void ControlDependenceGraphBase::insertRegions(PostDominatorTree &pdt) {
-  typedef po_iterator<PostDominatorTree*> po_pdt_iterator;  
-  typedef std::pair<ControlDependenceNode::EdgeType, ControlDependenceNode *> cd_type;
-  typedef std::set<cd_type> cd_set_type;
-  typedef std::map<cd_set_type, ControlDependenceNode *> cd_map_type;
+// The loops of a function, copied out of LoopInfo. The graph that collapses
+// them owns the nest and shares it with the graphs of the loops it expands.
+struct ControlDependenceGraphBase::LoopNest {
+  std::deque<ControlDependenceLoop> loops;
+  DenseMap<const BasicBlock *, const ControlDependenceLoop *> innermost;
+
+  explicit LoopNest(const LoopInfo &LI);
+
+  const ControlDependenceLoop *getLoopFor(const BasicBlock *BB) const {
+    DenseMap<const BasicBlock *, const ControlDependenceLoop *>::const_iterator
+      L = innermost.find(BB);
+    return L == innermost.end() ? NULL : L->second;
+  }
+};
+
+// Copy the loops breadth first, so that every loop is copied after its parent
+// and its blocks end up mapped to the innermost loop containing them.
+ControlDependenceGraphBase::LoopNest::LoopNest(const LoopInfo &LI) {
+  std::deque<std::pair<const Loop *, const ControlDependenceLoop *> > worklist;
+  for (LoopInfo::iterator L = LI.begin(), E = LI.end(); L != E; ++L)
+    worklist.push_back(std::make_pair(*L, (const ControlDependenceLoop *)NULL));
+  while (!worklist.empty()) {
+    const Loop *L = worklist.front().first;
+    loops.push_back(ControlDependenceLoop());
+    ControlDependenceLoop &CL = loops.back();
+    CL.parent = worklist.front().second;
+    CL.blocks = L->getBlocks();
+    worklist.pop_front();
+    for (std::vector<BasicBlock *>::const_iterator BB = CL.blocks.begin(),
+	   E = CL.blocks.end(); BB != E; ++BB)
+      innermost[*BB] = &CL;
+    for (Loop::iterator Sub = L->begin(), E = L->end(); Sub != E; ++Sub)
+      worklist.push_back(std::make_pair(*Sub, (const ControlDependenceLoop *)&CL));
+  }
+}
+
+// The state shared by the phases of graph construction. Each vertex is a
+// single block or, when loops are collapsed, a whole loop represented by its
+// header. On top of the engine's flat graph, the state keeps the collapsed
+// loop of each vertex and accounts for the budget, which its exhausted hook
+// enforces; its isSmall hook lets -cdg-min-tier turn the small tier off.
+struct ControlDependenceGraphBase::BuildState : public Vertices {
+  SmallVector<const ControlDependenceLoop *, SmallSize> loops;
+
+  // Budget accounting. Reading the clock is not free, so it only happens
+  // once every BudgetCheckInterval units of work. Memory is charged against
+  // what construction itself allocates: the flat arrays and the nodes made
+  // from them, and WorkBytes for each unit of work, which adds at most one
+  // edge, an entry in each of two node sets.
+  static const unsigned BudgetCheckInterval = 4096;
+  static const size_t WorkBytes = 2 * 6 * sizeof(void *);
+  const ControlDependenceOptions &options;
+  sys::TimeValue startTime;
+  size_t bytes;
+  unsigned work;
+
+  BuildState(const ControlDependenceOptions &O)
+    : options(O), startTime(O.TimeBudgetMS ? sys::TimeValue::now() : sys::TimeValue()),
+      bytes(0), work(0) {}
+
+  bool isSmall() const {
+    return blocks.size() < SmallSize && options.MinTier <= SmallTier;
+  }
+  const Function *function() const { return blocks.front()->getParent(); }
+
+  void numberVertices(ArrayRef<BasicBlock *> scope, const LoopNest *nest,
+		      const ControlDependenceLoop *outer, const ControlDependenceGraphBase &G);
+  void ipdomsFromBuilder(PostDominatorBuilder &pdb);
+  void ipdomsFromTree(PostDominatorTree &pdt);
 
-  cd_map_type cdMap;
-  cd_set_type initCDs;
-  initCDs.insert(std::make_pair(ControlDependenceNode::OTHER, root));
-  cdMap.insert(std::make_pair(initCDs,root));
+  // Charge the flat arrays and numNodes nodes, all of which exist before
+  // the phases that do the work start, and report whether they alone
+  // exhaust the memory budget.
+  bool chargeStorage(size_t numNodes) {
+    bytes = numNodes * sizeof(ControlDependenceNode) + index.getMemorySize() +
+      capacity_in_bytes(blocks) + capacity_in_bytes(loops) +
+      capacity_in_bytes(succBegin) + capacity_in_bytes(succs) +
+      capacity_in_bytes(succTypes) + capacity_in_bytes(cdNodes) +
+      capacity_in_bytes(ipdom) + capacity_in_bytes(childBegin) +
+      capacity_in_bytes(children) + capacity_in_bytes(dfsIn) +
+      capacity_in_bytes(dfsOut) + capacity_in_bytes(postorder);
+    return options.MemoryBudget && bytes > options.MemoryBudget;
+  }
+
+  // Record a unit of work and report whether the budget is exhausted.
+  bool exhausted() {
+    bytes += WorkBytes;
+    if (options.MemoryBudget && bytes > options.MemoryBudget)
+      return true;
+    if (++work % BudgetCheckInterval != 0)
+      return false;
+    return options.TimeBudgetMS &&
+      (sys::TimeValue::now() - startTime).msec() > options.TimeBudgetMS;
+  }
+};
 
-  for (po_pdt_iterator DTN = po_pdt_iterator::begin(&pdt), END = po_pdt_iterator::end(&pdt);
-       DTN != END; ++DTN) {
-    if (!DTN->getBlock())
+// Number the blocks of scope, whose first element is its entry. With nest, the
+// blocks of each loop nested directly in outer (top-level loops when outer is
+// NULL) share one vertex. Edges leaving the scope lead to the virtual exit.
+void ControlDependenceGraphBase::BuildState::numberVertices(ArrayRef<BasicBlock *> scope,
+							      const LoopNest *nest,
+							      const ControlDependenceLoop *outer,
+							      const ControlDependenceGraphBase &G) {
+  DenseMap<const ControlDependenceLoop *, unsigned> loopVertex;
+  for (ArrayRef<BasicBlock *>::iterator BB = scope.begin(), E = scope.end();
+       BB != E; ++BB) {
+    const ControlDependenceLoop *L = nest ? nest->getLoopFor(*BB) : NULL;
+    while (L && L != outer && L->getParentLoop() != outer)
+      L = L->getParentLoop();
+    if (!L || L == outer) {
+      addVertex(*BB);
+      loops.push_back(NULL);
       continue;
+    }
+    DenseMap<const ControlDependenceLoop *, unsigned>::iterator LV = loopVertex.find(L);
+    if (LV == loopVertex.end()) {
+      LV = loopVertex.insert(std::make_pair(L, addVertex(L->getHeader()))).first;
+      loops.push_back(L);
+    }
+    index[*BB] = LV->second;
+  }
+  assert(index[scope.front()] == 0 && "Scope entry must be its own vertex!");
 
-    ControlDependenceNode *node = bbMap[DTN->getBlock()];
-    assert(node);
-
-    cd_set_type cds;
-    for (ControlDependenceNode::node_iterator P = node->Parents.begin(), E = node->Parents.end(); P != E; ++P) {
-      ControlDependenceNode *parent = *P;
-      if (parent->TrueChildren.find(node) != parent->TrueChildren.end())
-	cds.insert(std::make_pair(ControlDependenceNode::TRUE, parent));
-      if (parent->FalseChildren.find(node) != parent->FalseChildren.end())
-	cds.insert(std::make_pair(ControlDependenceNode::FALSE, parent));
-      if (parent->OtherChildren.find(node) != parent->OtherChildren.end())
-	cds.insert(std::make_pair(ControlDependenceNode::OTHER, parent));
+  // Edges inside a collapsed loop vanish, and a collapsed loop cannot tell
+  // its exits apart, so every edge out of it is labelled OTHER.
+  ControlDependenceLabels<BasicBlock> labels;
+  beginEdges();
+  for (ArrayRef<BasicBlock *>::iterator BB = scope.begin(), E = scope.end();
+       BB != E; ++BB) {
+    BasicBlock *A = *BB;
+    unsigned a = index[A];
+    for (succ_iterator succ = succ_begin(A), end = succ_end(A); succ != end; ++succ) {
+      if (!G.isFeasibleEdge(A,*succ))
+	continue;
+      index_map::iterator I = index.find(*succ);
+      unsigned b = I == index.end() ? exit() : I->second;
+      if (loops[a] && b == a)
+	continue;
+      addEdge(a, b, loops[a] ? ControlDependenceNode::OTHER : labels.getEdgeType(A,*succ));
     }
+  }
+  endEdges();
+}
 
-    cd_map_type::iterator CDEntry = cdMap.find(cds);
-    ControlDependenceNode *region;
-    if (CDEntry == cdMap.end()) {
-      region = new ControlDependenceNode();
-      nodes.insert(region);
-      cdMap.insert(std::make_pair(cds,region));
-      for (cd_set_type::iterator CD = cds.begin(), CDEnd = cds.end(); CD != CDEnd; ++CD) {
-	switch (CD->first) {
-	case ControlDependenceNode::TRUE:
-	  CD->second->addTrue(region);
-	  break;
-	case ControlDependenceNode::FALSE:
-	  CD->second->addFalse(region);
-	  break;
-	case ControlDependenceNode::OTHER:
-	  CD->second->addOther(region); 
+void ControlDependenceGraphBase::BuildState::ipdomsFromBuilder(PostDominatorBuilder &pdb) {
+  TracePhase P("postDominators", function());
+  pdb.compute(blocks.size(), succBegin, succs, ipdom);
+}
+
+void ControlDependenceGraphBase::BuildState::ipdomsFromTree(PostDominatorTree &pdt) {
+  TracePhase P("postDominators", function());
+  Vertices::ipdomsFromTree(pdt);
+}
+
+// Create the nodes of S, and remember which of them stand for collapsed
+// loops.
+void ControlDependenceGraphBase::createNodes(BuildState &S) {
+  Engine::createNodes(S);
+  for (unsigned v = 0, e = S.blocks.size(); v != e; ++v)
+    if (S.loops[v])
+      collapsedLoops[S.cdNodes[v]] = S.loops[v];
+}
+
+// Is F a chain of blocks, each with at most one feasible successor, that
+// starts at the entry and takes in every block? Every block then
+// post-dominates the entry and nothing controls anything.
+bool ControlDependenceGraphBase::isStraightLine(Function &F) const {
+  size_t n = F.size(), length = 0;
+  for (BasicBlock *BB = &F.getEntryBlock(); BB; ) {
+    // A chain longer than the function has run into a cycle.
+    if (++length > n)
+      return false;
+    BasicBlock *next = NULL;
+    for (succ_iterator succ = succ_begin(BB), end = succ_end(BB); succ != end; ++succ) {
+      if (!isFeasibleEdge(BB,*succ))
+	continue;
+      if (next && next != *succ)
+	return false;
+      next = *succ;
+    }
+    BB = next;
+  }
+  return length == n;
+}
+
+// Build the graph of a straight-line function directly: every block hangs
+// off the root. This is what the full engine would build, without any of
+// its scratch storage.
+void ControlDependenceGraphBase::buildTrivialGraph(Function &F) {
+  tier = TrivialTier;
+  root = newNode();
+  for (Function::iterator BB = F.begin(), E = F.end(); BB != E; ++BB) {
+    ControlDependenceNode *N = newNode(BB);
+    blockMap[BB] = N;
+    addChild(root, N, ControlDependenceNode::OTHER);
+  }
+}
+
+// Build a graph linear in the number of vertices without looking at
+// post-dominators: every vertex sits alone in its own region, and all of
+// these regions hang off one hub that every branch controls. Each block thus
+// appears influenced by every branch and no two vertices appear control
+// equivalent.
+void ControlDependenceGraphBase::buildApproximateGraph(BuildState &S) {
+  createNodes(S);
+  ControlDependenceNode *hub = newNode();
+  addChild(root, hub, ControlDependenceNode::OTHER);
+
+  for (unsigned v = 0, e = S.blocks.size(); v != e; ++v) {
+    ControlDependenceNode *vn = S.cdNodes[v];
+    ControlDependenceNode *region = newNode();
+    addChild(hub, region, ControlDependenceNode::OTHER);
+    addChild(region, vn, ControlDependenceNode::OTHER);
+    if (S.succBegin[v+1] - S.succBegin[v] > 1)
+      addChild(vn, hub, ControlDependenceNode::OTHER);
+  }
+  approximate = true;
+}
+
+// Build the graph described by S, or clear everything and report failure if
+// the budget runs out first.
+bool ControlDependenceGraphBase::buildGraph(BuildState &S) {
+  const Function *F = S.function();
+  tier = S.isSmall() ? SmallTier : FullTier;
+  bool built;
+  {
+    TracePhase P("computeDependencies", F);
+    createNodes(S);
+    built = !S.chargeStorage(nodes.size()) && computeDependencies(S);
+  }
+  if (built) {
+    TracePhase P("insertRegions", F);
+    built = insertRegions(S);
+  }
+  if (!built) {
+    clearNodes();
+    return false;
+  }
+  TracePhase P("splitTrueFalseEdges", F);
+  splitTrueFalseEdges();
+  return true;
+}
+
+namespace {
+
+// Orders vertices by their lists of control dependences, given as the
+// ranges of a flat array that belong to each.
+struct DependenceOrder {
+  const std::vector<unsigned> &begin, &deps;
+
+  DependenceOrder(const std::vector<unsigned> &B, const std::vector<unsigned> &D)
+    : begin(B), deps(D) {}
+  bool operator()(unsigned A, unsigned B) const {
+    return std::lexicographical_compare(deps.begin() + begin[A], deps.begin() + begin[A+1],
+					deps.begin() + begin[B], deps.begin() + begin[B+1]);
+  }
+  bool equal(unsigned A, unsigned B) const {
+    return begin[A+1] - begin[A] == begin[B+1] - begin[B] &&
+      std::equal(deps.begin() + begin[A], deps.begin() + begin[A+1], deps.begin() + begin[B]);
+  }
+};
+
+} // end anonymous namespace
+
+// Summarize the regions of the graph S describes into R without building
+// it. The dependences computeDependencies would add as edges are gathered
+// as pairs of a vertex and a code for its controller, 3 * ID + label where
+// ID is that of the controller's node; the root's is 0. Sorted, they give
+// each vertex's list of dependences, and vertices with the same list make up
+// the region insertRegions would create for them. An approximate summary
+// records no controllers. Report failure if the budget runs out first.
+bool ControlDependenceGraphBase::summarizeRegions(const Function &F, BuildState &S,
+						  ControlDependenceRegions &R,
+						  bool approximate) {
+  TracePhase P("summarizeRegions", &F);
+  unsigned n = S.blocks.size();
+  if (S.chargeStorage(0))
+    return false;
+
+  std::vector<std::pair<unsigned, unsigned> > pairs;
+  std::vector<unsigned> reached(n, ~0U);
+  for (unsigned a = 0; a != n; ++a) {
+    for (unsigned i = S.succBegin[a], ie = S.succBegin[a+1]; i != ie; ++i) {
+      unsigned b = S.succs[i];
+      if (a != b && S.postDominates(b,a))
+	continue;
+      unsigned l = S.postDominates(a,b) ? a : S.ipdom[a];
+      unsigned code = 3 * (a + 1) + S.succTypes[i];
+      if (a == l)
+	pairs.push_back(std::make_pair(a, code));
+      for (unsigned cur = b; cur != l && cur != S.exit(); cur = S.ipdom[cur]) {
+	if (reached[cur] == code)
 	  break;
-	}
-	region->addParent(CD->second);
+	reached[cur] = code;
+	pairs.push_back(std::make_pair(cur, code));
+	if (S.exhausted())
+	  return false;
       }
-    } else {
-      region = CDEntry->second;
     }
-    for (cd_set_type::iterator CD = cds.begin(), CDEnd = cds.end(); CD != CDEnd; ++CD) {
-      switch (CD->first) {
-      case ControlDependenceNode::TRUE:
-	CD->second->removeTrue(node);
-	break;
-      case ControlDependenceNode::FALSE:
-	CD->second->removeFalse(node);
-	break;
-      case ControlDependenceNode::OTHER:
-	CD->second->removeOther(node);
-	break;
+  }
+  const unsigned rootCode = ControlDependenceNode::OTHER;
+  for (unsigned cur = 0; cur != S.exit(); cur = S.ipdom[cur])
+    pairs.push_back(std::make_pair(cur, rootCode));
+  std::sort(pairs.begin(), pairs.end());
+  pairs.erase(std::unique(pairs.begin(), pairs.end()), pairs.end());
+
+  std::vector<unsigned> begin(n + 1, 0), deps(pairs.size());
+  for (unsigned i = 0, e = pairs.size(); i != e; ++i) {
+    ++begin[pairs[i].first + 1];
+    deps[i] = pairs[i].second;
+  }
+  std::vector<std::pair<unsigned, unsigned> >().swap(pairs);
+  for (unsigned v = 0; v != n; ++v)
+    begin[v+1] += begin[v];
+
+  // Group the vertices with the same dependences. The vertices that only the
+  // root controls form the root region.
+  DependenceOrder order(begin, deps);
+  std::vector<unsigned> sorted(n), group(n);
+  for (unsigned v = 0; v != n; ++v)
+    sorted[v] = v;
+  std::sort(sorted.begin(), sorted.end(), order);
+  unsigned groups = 0;
+  for (unsigned i = 0; i != n; ++i) {
+    if (i && !order.equal(sorted[i-1], sorted[i]))
+      ++groups;
+    group[sorted[i]] = groups;
+  }
+  unsigned rootGroup = ~0U;
+  if (begin[1] - begin[0] == 1 && deps[begin[0]] == rootCode)
+    rootGroup = group[0];
+
+  // Number the regions in the order of their first block, root first, as
+  // summarize() does.
+  std::vector<unsigned> region(groups + 1, ControlDependenceRegions::NoRegion);
+  std::vector<unsigned> first;
+  first.push_back(~0U);
+  R.clear();
+  R.approximate = approximate;
+  for (Function::const_iterator BB = F.begin(), E = F.end(); BB != E; ++BB) {
+    unsigned v = S.index.lookup(BB);
+    unsigned &id = region[group[v]];
+    if (id == ControlDependenceRegions::NoRegion) {
+      if (group[v] == rootGroup) {
+	id = R.getRootRegion();
+      } else {
+	id = first.size();
+	first.push_back(v);
       }
-      region->addOther(node);
-      node->addParent(region);
-      node->removeParent(CD->second);
     }
+    R.regionOf[BB] = id;
+    if (id == R.getRootRegion() && S.blocks[v] != &*BB)
+      R.loopBodies.insert(BB);
   }
 
-  // Make sure that each node has at most one true or false edge
-  for (std::set<ControlDependenceNode *>::iterator N = nodes.begin(), E = nodes.end();
-       N != E; ++N) {
-    ControlDependenceNode *node = *N;
-    assert(node);
-    if (node->isRegion())
+  R.controllerBegin.push_back(0);
+  for (unsigned r = 0, e = first.size(); r != e; ++r) {
+    if (approximate || !r) {
+      R.controllerBegin.push_back(R.controllers.size());
       continue;
+    }
+    for (unsigned i = begin[first[r]], ie = begin[first[r]+1]; i != ie; ++i) {
+      ControlDependenceRegions::Controller C;
+      C.Branch = deps[i] / 3 ? S.blocks[deps[i] / 3 - 1] : NULL;
+      C.Type = (ControlDependenceNode::EdgeType)(deps[i] % 3);
+      R.controllers.push_back(C);
+    }
+    R.controllerBegin.push_back(R.controllers.size());
+  }
+  R.buildTree();
+  return true;
+}
 
-    // Fix too many true nodes
-    if (node->TrueChildren.size() > 1) {
-      ControlDependenceNode *region = new ControlDependenceNode();
-      nodes.insert(region);
-      for (ControlDependenceNode::node_iterator C = node->true_begin(), CE = node->true_end();
-	   C != CE; ++C) {
-	ControlDependenceNode *child = *C;
-	assert(node);
-	assert(child);
-	assert(region);
-	region->addOther(child);
-	child->addParent(region);
-	child->removeParent(node);
-	node->removeTrue(child);
-      }
-      node->addTrue(region);
-      region->addParent(node);
+// Summarize the regions of the approximate graph buildApproximateGraph would
+// build from S: every vertex in a region of its own, and no controllers.
+void ControlDependenceGraphBase::summarizeApproximateRegions(const Function &F, BuildState &S,
+							     ControlDependenceRegions &R) {
+  std::vector<unsigned> region(S.blocks.size(), ControlDependenceRegions::NoRegion);
+  unsigned regions = 1;
+  R.clear();
+  R.approximate = true;
+  for (Function::const_iterator BB = F.begin(), E = F.end(); BB != E; ++BB) {
+    unsigned &id = region[S.index.lookup(BB)];
+    if (id == ControlDependenceRegions::NoRegion)
+      id = regions++;
+    R.regionOf[BB] = id;
+  }
+  R.controllerBegin.assign(regions + 1, 0);
+  R.buildTree();
+}
+
+// Complete a freshly built graph and announce it to the observers.
+void ControlDependenceGraphBase::finishGraph() {
+  if (options.HashRegions)
+    computeHashes();
+  for (std::vector<ControlDependenceObserver *>::iterator O = observers.begin(),
+	 OE = observers.end(); O != OE; ++O)
+    for (unsigned i = 0, e = nodes.size(); i != e; ++i)
+      (*O)->nodeAdded(nodes[i]);
+  announced = true;
+}
+
+void ControlDependenceGraphBase::clearNodes() {
+  // Graphs discarded half-built were never announced.
+  if (announced) {
+    for (std::vector<ControlDependenceObserver *>::iterator O = observers.begin(),
+	   OE = observers.end(); O != OE; ++O) {
+      (*O)->graphInvalidated(*this);
+      for (unsigned i = 0, e = nodes.size(); i != e; ++i)
+	(*O)->nodeRemoved(nodes[i]);
+    }
+    announced = false;
+  }
+  Engine::clear();
+  for (std::map<const ControlDependenceLoop *, ControlDependenceGraphBase *>::iterator
+	 L = expandedLoops.begin(), E = expandedLoops.end(); L != E; ++L)
+    delete L->second;
+  if (ownsLoopNest)
+    delete loopNest;
+  hashes.clear();
+  controlledSets.clear();
+  collapsedLoops.clear();
+  expandedLoops.clear();
+  loopNest = NULL;
+  ownsLoopNest = false;
+  approximate = false;
+}
+
+void ControlDependenceGraphBase::graphForFunction(Function &F, PostDominatorTree &pdt,
+                                                  LazyValueInfo *LVI) {
+  TracePhase P("graphForFunction", &F);
+  ControlDependenceGraphBase::releaseMemory();
+  if (options.PruneInfeasibleEdges)
+    pruneInfeasibleEdges(F,LVI);
+  if (options.MinTier <= TrivialTier && isStraightLine(F)) {
+    buildTrivialGraph(F);
+    finishGraph();
+    return;
+  }
+
+  BuildState S(options);
+  SmallVector<BasicBlock *, BuildState::SmallSize> scope;
+  for (Function::iterator BB = F.begin(), E = F.end(); BB != E; ++BB)
+    scope.push_back(BB);
+  S.numberVertices(scope,NULL,NULL,*this);
+  // pdt describes the whole CFG. Once edges are pruned, the taken successor
+  // of a constant branch may post-dominate it, so the post-dominators are
+  // computed afresh over the pruned CFG.
+  if (infeasibleEdges.empty()) {
+    S.ipdomsFromTree(pdt);
+  } else {
+    PostDominatorBuilder pdb;
+    S.ipdomsFromBuilder(pdb);
+  }
+  S.buildTree();
+  if (!buildGraph(S))
+    buildApproximateGraph(S);
+  finishGraph();
+}
+
+void ControlDependenceGraphBase::graphForFunction(Function &F, PostDominatorBuilder &pdb,
+                                                  LazyValueInfo *LVI, LoopInfo *LI) {
+  TracePhase P("graphForFunction", &F);
+  ControlDependenceGraphBase::releaseMemory();
+  if (options.PruneInfeasibleEdges)
+    pruneInfeasibleEdges(F,LVI);
+  bool collapse = options.CollapseLoops && LI;
+  if (options.MinTier <= TrivialTier && isStraightLine(F)) {
+    buildTrivialGraph(F);
+    if (collapse) {
+      loopNest = new LoopNest(*LI);
+      ownsLoopNest = true;
+    }
+    finishGraph();
+    return;
+  }
+
+  BuildState S(options);
+  SmallVector<BasicBlock *, BuildState::SmallSize> scope;
+  for (Function::iterator BB = F.begin(), E = F.end(); BB != E; ++BB)
+    scope.push_back(BB);
+
+  LoopNest *nest = collapse ? new LoopNest(*LI) : NULL;
+  S.numberVertices(scope,nest,NULL,*this);
+  S.ipdomsFromBuilder(pdb);
+  S.buildTree();
+  if (buildGraph(S)) {
+    loopNest = nest;
+    ownsLoopNest = collapse;
+  } else if (!LI || collapse) {
+    buildApproximateGraph(S);
+    loopNest = nest;
+    ownsLoopNest = collapse;
+  } else {
+    retryCollapsed(scope,pdb,*LI);
+  }
+  finishGraph();
+}
+
+void ControlDependenceGraphBase::regionsForFunction(Function &F, PostDominatorBuilder &pdb,
+                                                    ControlDependenceRegions &R,
+                                                    LazyValueInfo *LVI, LoopInfo *LI) {
+  TracePhase P("regionsForFunction", &F);
+  ControlDependenceGraphBase::releaseMemory();
+  if (options.PruneInfeasibleEdges)
+    pruneInfeasibleEdges(F,LVI);
+  bool collapse = options.CollapseLoops && LI;
+  if (options.MinTier <= TrivialTier && isStraightLine(F)) {
+    // Every block is in the root region, which nothing controls.
+    R.clear();
+    for (Function::iterator BB = F.begin(), E = F.end(); BB != E; ++BB)
+      R.regionOf[BB] = R.getRootRegion();
+    R.controllerBegin.assign(2, 0);
+    R.buildTree();
+    ControlDependenceGraphBase::releaseMemory();
+    return;
+  }
+
+  // Follow graphForFunction, down to the collapsed retry when the budget
+  // runs out at block level.
+  SmallVector<BasicBlock *, BuildState::SmallSize> scope;
+  for (Function::iterator BB = F.begin(), E = F.end(); BB != E; ++BB)
+    scope.push_back(BB);
+  LoopNest *nest = collapse ? new LoopNest(*LI) : NULL;
+  bool summarized;
+  {
+    BuildState S(options);
+    S.numberVertices(scope,nest,NULL,*this);
+    S.ipdomsFromBuilder(pdb);
+    S.buildTree();
+    summarized = summarizeRegions(F,S,R,false);
+    if (!summarized && (!LI || collapse)) {
+      summarizeApproximateRegions(F,S,R);
+      summarized = true;
     }
+  }
+  if (!summarized) {
+    nest = new LoopNest(*LI);
+    BuildState C(options);
+    C.numberVertices(scope,nest,NULL,*this);
+    C.ipdomsFromBuilder(pdb);
+    C.buildTree();
+    if (!summarizeRegions(F,C,R,true))
+      summarizeApproximateRegions(F,C,R);
+  }
+  delete nest;
+  ControlDependenceGraphBase::releaseMemory();
+}
 
-    // Fix too many false nodes
-    if (node->FalseChildren.size() > 1) {
-      ControlDependenceNode *region = new ControlDependenceNode();
-      nodes.insert(region);
-      for (ControlDependenceNode::node_iterator C = node->false_begin(), CE = node->false_end();
-	   C != CE; ++C) {
+// Build the graph of the function whose blocks are scope at loop level, with
+// a fresh budget, after running out of budget at block level. The result is
+// approximate either way.
+void ControlDependenceGraphBase::retryCollapsed(ArrayRef<BasicBlock *> scope,
+                                                PostDominatorBuilder &pdb, LoopInfo &LI) {
+  BuildState C(options);
+  LoopNest *nest = new LoopNest(LI);
+  C.numberVertices(scope,nest,NULL,*this);
+  C.ipdomsFromBuilder(pdb);
+  C.buildTree();
+  if (!buildGraph(C))
+    buildApproximateGraph(C);
+  loopNest = nest;
+  ownsLoopNest = true;
+  approximate = true;
+}
+
+void ControlDependenceGraphBase::graphForLoop(const ControlDependenceLoop *L,
+                                              PostDominatorBuilder &pdb) {
+  BuildState S(options);
+  S.numberVertices(L->getBlocks(),loopNest,L,*this);
+  S.ipdomsFromBuilder(pdb);
+  S.buildTree();
+  if (!buildGraph(S))
+    buildApproximateGraph(S);
+  finishGraph();
+}
+
+ControlDependenceGraphBase &
+ControlDependenceGraphBase::expandLoop(const ControlDependenceLoop *L,
+                                       PostDominatorBuilder &pdb) {
+  assert(loopNest && "Only loop-collapsed graphs can expand loops!");
+  ControlDependenceGraphBase *&G = expandedLoops[L];
+  if (!G) {
+    G = new ControlDependenceGraphBase();
+    G->options = options;
+    G->observers = observers;
+    G->infeasibleEdges = infeasibleEdges;
+    G->loopNest = loopNest;
+    G->graphForLoop(L,pdb);
+  }
+  return *G;
+}
+
+void ControlDependenceGraphBase::removeObserver(ControlDependenceObserver *O) {
+  observers.erase(std::remove(observers.begin(), observers.end(), O), observers.end());
+}
+
+const ControlDependenceLoop *
+ControlDependenceGraphBase::getCollapsedLoop(const ControlDependenceNode *N) const {
+  std::map<const ControlDependenceNode *, const ControlDependenceLoop *>::const_iterator
+    L = collapsedLoops.find(N);
+  return L == collapsedLoops.end() ? NULL : L->second;
+}
+
+const ControlDependenceGraphBase::ControlledSet &
+ControlDependenceGraphBase::controlledSet(const BasicBlock *A) const {
+  const ControlDependenceNode *n = getNode(A);
+  assert(n && "Basic block not in control dependence graph!");
+  // A set is only ever filled once, and std::map keeps it in place as
+  // others are added, so it can be read without the lock once returned.
+  MutexGuard Guard(controlledLock);
+  ControlledSet &S = controlledSets[n->getID()];
+  if (S.nodes.size() == nodes.size())
+    return S;
+
+  // One walk down from A; loops make the graph cyclic, so the set itself
+  // records what has been queued. Regions are queued but not kept.
+  BitVector queued(nodes.size());
+  S.nodes.resize(nodes.size());
+  std::vector<ControlDependenceNode *> worklist(1, nodes[n->getID()]);
+  while (!worklist.empty()) {
+    ControlDependenceNode *x = worklist.back();
+    worklist.pop_back();
+    for (ControlDependenceNode::edge_iterator C = x->begin(), E = x->end(); C != E; ++C) {
+      unsigned id = (*C)->getID();
+      if (queued.test(id))
+	continue;
+      queued.set(id);
+      worklist.push_back(*C);
+      if (!(*C)->isRegion())
+	S.nodes.set(id);
+    }
+  }
+  for (int i = S.nodes.find_first(); i != -1; i = S.nodes.find_next(i))
+    S.blocks.push_back(nodes[i]->getBlock());
+  return S;
+}
+
+const BitVector &ControlDependenceGraphBase::controlledNodes(const BasicBlock *A) const {
+  return controlledSet(A).nodes;
+}
+
+ArrayRef<BasicBlock *> ControlDependenceGraphBase::controlledBlocks(const BasicBlock *A) const {
+  return controlledSet(A).blocks;
+}
+
+namespace {
+
+// Hashes what blocks compute so that the hash survives edits elsewhere in the
+// function: values defined earlier in the same block are identified by
+// position, values of other blocks and the blocks themselves by the index
+// of the block in the function, constants by contents, globals by name and
+// arguments by number. Types are hashed by shape, and instructions by
+// opcode, type and whatever else sets them apart beyond their operands:
+// predicates, wrap and exactness flags, volatility, ordering and alignment
+// of memory accesses, and the calling convention and attributes of calls.
+class BlockHasher {
+public:
+  explicit BlockHasher(const Function &F) {
+    unsigned n = 0;
+    for (Function::const_iterator BB = F.begin(), E = F.end(); BB != E; ++BB)
+      blockIndex[BB] = n++;
+  }
+
+  hash_code hashBlock(const BasicBlock *BB);
+
+private:
+  DenseMap<const BasicBlock *, unsigned> blockIndex;
+  DenseMap<const Value *, unsigned> local;
+
+  hash_code hashType(const Type *T);
+  hash_code hashConstant(const Constant *C);
+  hash_code hashOperand(const Value *V);
+  hash_code hashInstruction(const Instruction *I);
+};
+
+} // end anonymous namespace
+
+hash_code BlockHasher::hashType(const Type *T) {
+  hash_code H = hash_value(T->getTypeID());
+  switch (T->getTypeID()) {
+  case Type::IntegerTyID:
+    return hash_combine(H, cast<IntegerType>(T)->getBitWidth());
+  case Type::PointerTyID:
+    return hash_combine(H, T->getPointerAddressSpace(),
+			hashType(T->getPointerElementType()));
+  case Type::ArrayTyID:
+  case Type::VectorTyID:
+    return hash_combine(H, cast<SequentialType>(T)->getNumElements(),
+			hashType(T->getSequentialElementType()));
+  case Type::StructTyID: {
+    // Named structs may be recursive, so they are known by name alone.
+    const StructType *ST = cast<StructType>(T);
+    if (ST->hasName())
+      return hash_combine(H, ST->getName());
+    H = hash_combine(H, ST->isPacked());
+    break;
+  }
+  case Type::FunctionTyID:
+    H = hash_combine(H, cast<FunctionType>(T)->isVarArg());
+    break;
+  default:
+    return H;
+  }
+  for (Type::subtype_iterator S = T->subtype_begin(), SE = T->subtype_end(); S != SE; ++S)
+    H = hash_combine(H, hashType(*S));
+  return H;
+}
+
+hash_code BlockHasher::hashConstant(const Constant *C) {
+  hash_code H = hash_combine(C->getValueID(), hashType(C->getType()));
+  if (const GlobalValue *G = dyn_cast<GlobalValue>(C))
+    return hash_combine(H, G->getName());
+  if (const ConstantInt *CI = dyn_cast<ConstantInt>(C))
+    return hash_combine(H, CI->getValue());
+  if (const ConstantFP *CF = dyn_cast<ConstantFP>(C))
+    return hash_combine(H, CF->getValueAPF().bitcastToAPInt());
+  if (const ConstantDataSequential *CD = dyn_cast<ConstantDataSequential>(C))
+    return hash_combine(H, CD->getRawDataValues());
+  if (const ConstantExpr *CE = dyn_cast<ConstantExpr>(C)) {
+    H = hash_combine(H, CE->getOpcode(), CE->getRawSubclassOptionalData());
+    if (CE->isCompare())
+      H = hash_combine(H, CE->getPredicate());
+    if (CE->hasIndices())
+      H = hash_combine(H, hash_combine_range(CE->getIndices().begin(), CE->getIndices().end()));
+  }
+  if (const BlockAddress *BA = dyn_cast<BlockAddress>(C))
+    return hash_combine(H, BA->getFunction()->getName(),
+			blockIndex.lookup(BA->getBasicBlock()));
+  // Aggregates and expressions are hashed by their operands; constants
+  // without any, such as null or undef, by kind and type.
+  for (User::const_op_iterator O = C->op_begin(), OE = C->op_end(); O != OE; ++O)
+    H = hash_combine(H, hashConstant(cast<Constant>(*O)));
+  return H;
+}
+
+hash_code BlockHasher::hashOperand(const Value *V) {
+  DenseMap<const Value *, unsigned>::const_iterator L = local.find(V);
+  if (L != local.end())
+    return hash_combine(0u, L->second);
+  if (const Constant *C = dyn_cast<Constant>(V))
+    return hash_combine(1u, hashConstant(C));
+  if (const Argument *A = dyn_cast<Argument>(V))
+    return hash_combine(2u, A->getArgNo());
+  if (const BasicBlock *BB = dyn_cast<BasicBlock>(V))
+    return hash_combine(3u, blockIndex.lookup(BB));
+  if (const Instruction *I = dyn_cast<Instruction>(V))
+    return hash_combine(4u, blockIndex.lookup(I->getParent()), hashType(I->getType()));
+  return hash_combine(5u, V->getValueID(), hashType(V->getType()));
+}
+
+hash_code BlockHasher::hashInstruction(const Instruction *I) {
+  hash_code H = hash_combine(I->getOpcode(), hashType(I->getType()), I->getNumOperands(),
+			     I->getRawSubclassOptionalData());
+  if (const CmpInst *C = dyn_cast<CmpInst>(I))
+    H = hash_combine(H, C->getPredicate());
+  else if (const LoadInst *L = dyn_cast<LoadInst>(I))
+    H = hash_combine(H, L->isVolatile(), L->getAlignment(), L->getOrdering(),
+		     L->getSynchScope());
+  else if (const StoreInst *S = dyn_cast<StoreInst>(I))
+    H = hash_combine(H, S->isVolatile(), S->getAlignment(), S->getOrdering(),
+		     S->getSynchScope());
+  else if (const AllocaInst *A = dyn_cast<AllocaInst>(I))
+    H = hash_combine(H, A->getAlignment(), hashType(A->getAllocatedType()));
+  else if (const AtomicRMWInst *R = dyn_cast<AtomicRMWInst>(I))
+    H = hash_combine(H, R->getOperation(), R->isVolatile(), R->getOrdering(),
+		     R->getSynchScope());
+  else if (const AtomicCmpXchgInst *X = dyn_cast<AtomicCmpXchgInst>(I))
+    H = hash_combine(H, X->isVolatile(), X->getSuccessOrdering(), X->getFailureOrdering(),
+		     X->getSynchScope());
+  else if (const ExtractValueInst *E = dyn_cast<ExtractValueInst>(I))
+    H = hash_combine(H, hash_combine_range(E->idx_begin(), E->idx_end()));
+  else if (const InsertValueInst *E = dyn_cast<InsertValueInst>(I))
+    H = hash_combine(H, hash_combine_range(E->idx_begin(), E->idx_end()));
+  else if (const PHINode *P = dyn_cast<PHINode>(I))
+    for (unsigned i = 0, e = P->getNumIncomingValues(); i != e; ++i)
+      H = hash_combine(H, blockIndex.lookup(P->getIncomingBlock(i)));
+
+  ImmutableCallSite CS(I);
+  if (CS) {
+    H = hash_combine(H, CS.getCallingConv(), CS.isCall() && cast<CallInst>(I)->isTailCall());
+    AttributeSet Attrs = CS.getAttributes();
+    for (unsigned i = 0, e = Attrs.getNumSlots(); i != e; ++i) {
+      unsigned Index = Attrs.getSlotIndex(i);
+      H = hash_combine(H, Index, Attrs.getAsString(Index));
+    }
+  }
+  for (User::const_op_iterator O = I->op_begin(), OE = I->op_end(); O != OE; ++O)
+    H = hash_combine(H, hashOperand(*O));
+  return H;
+}
+
+hash_code BlockHasher::hashBlock(const BasicBlock *BB) {
+  local.clear();
+  hash_code H = hash_value(BB->size());
+  for (BasicBlock::const_iterator I = BB->begin(), E = BB->end(); I != E; ++I) {
+    H = hash_combine(H, hashInstruction(I));
+    unsigned n = local.size();
+    local[&*I] = n;
+  }
+  return H;
+}
+
+void ControlDependenceGraphBase::computeHashes() {
+  unsigned n = nodes.size();
+
+  // What each node computes by itself: a block or collapsed loop its
+  // instructions, a region those of the blocks it holds.
+  std::vector<uint64_t> content(n, 0);
+  const Function *F = NULL;
+  for (unsigned i = 0; i != n && !F; ++i)
+    if (!nodes[i]->isRegion())
+      F = nodes[i]->getBlock()->getParent();
+  if (!F) {
+    hashes.clear();
+    return;
+  }
+  BlockHasher hasher(*F);
+  for (unsigned i = 0; i != n; ++i) {
+    ControlDependenceNode *N = nodes[i];
+    if (N->isRegion())
+      continue;
+    if (const ControlDependenceLoop *L = getCollapsedLoop(N)) {
+      hash_code H = hash_value(L->getBlocks().size());
+      for (std::vector<BasicBlock *>::const_iterator B = L->getBlocks().begin(),
+	     BE = L->getBlocks().end(); B != BE; ++B)
+	H = hash_combine(H, hasher.hashBlock(*B));
+      content[i] = H;
+    } else {
+      content[i] = hasher.hashBlock(N->getBlock());
+    }
+  }
+  for (unsigned i = 0; i != n; ++i) {
+    ControlDependenceNode *N = nodes[i];
+    if (!N->isRegion())
+      continue;
+    hash_code H = hash_value(N->getNumChildren());
+    for (ControlDependenceNode::edge_iterator C = N->begin(), CE = N->end(); C != CE; ++C)
+      if (!(*C)->isRegion())
+	H = hash_combine(H, content[(*C)->getID()]);
+    content[i] = H;
+  }
+
+  // Hash bottom-up along a depth-first spanning tree, with an explicit
+  // stack. Nodes unreachable from the root start trees of their own.
+  typedef std::pair<ControlDependenceNode *, ControlDependenceNode::edge_iterator> frame;
+  std::vector<unsigned> treeParent(n, ~0U);
+  std::vector<bool> seen(n, false);
+  std::vector<frame> stack;
+  hashes.assign(n, 0);
+  for (unsigned r = 0; r != n; ++r) {
+    if (seen[r])
+      continue;
+    seen[r] = true;
+    stack.push_back(frame(nodes[r], nodes[r]->begin()));
+    while (!stack.empty()) {
+      ControlDependenceNode *N = stack.back().first;
+      ControlDependenceNode::edge_iterator &C = stack.back().second;
+      if (C != N->end()) {
 	ControlDependenceNode *child = *C;
-	region->addOther(child);
-	child->addParent(region);
-	child->removeParent(node);
-	node->removeFalse(child);
+	++C;
+	if (!seen[child->getID()]) {
+	  seen[child->getID()] = true;
+	  treeParent[child->getID()] = N->getID();
+	  stack.push_back(frame(child, child->begin()));
+	}
+	continue;
+      }
+      hash_code H = hash_combine(content[N->getID()], N->isRegion(), approximate);
+      for (ControlDependenceNode::edge_iterator E = N->begin(), EE = N->end(); E != EE; ++E) {
+	unsigned c = (*E)->getID();
+	H = hash_combine(H, E.type(), treeParent[c] == N->getID() ? hashes[c] : content[c]);
       }
-      node->addFalse(region);
-      region->addParent(node);
+      hashes[N->getID()] = H;
+      stack.pop_back();
     }
   }
 }
 
-void ControlDependenceGraphBase::graphForFunction(Function &F, PostDominatorTree &pdt) {
-  computeDependencies(F,pdt);
-  insertRegions(pdt);
+// Print node and its labelled edges on one line, marking it if it stands for
+// a collapsed loop.
+static void printNode(raw_ostream &OS, ControlDependenceNode *node, bool loop) {
+  OS << "  " << node->getID() << " ";
+  if (node->isRegion())
+    OS << "REGION";
+  else if (node->getBlock()->hasName())
+    OS << node->getBlock()->getName();
+  else
+    OS << "<unnamed>";
+  if (loop)
+    OS << " (loop)";
+  OS << ":";
+  for (ControlDependenceNode::edge_iterator C = node->begin(), CE = node->end();
+       C != CE; ++C) {
+    switch (C.type()) {
+    case ControlDependenceNode::TRUE:  OS << " T"; break;
+    case ControlDependenceNode::FALSE: OS << " F"; break;
+    case ControlDependenceNode::OTHER: OS << " "; break;
+    }
+    OS << (*C)->getID();
+  }
+  OS << "\n";
 }
 
-bool ControlDependenceGraphBase::controls(BasicBlock *A, BasicBlock *B) const {
-  const ControlDependenceNode *n = getNode(B);
-  assert(n && "Basic block not in control dependence graph!");
-  while (n->getNumParents() == 1) {
-    n = *n->parent_begin();
-    if (n->getBlock() == A)
-      return true;
+void ControlDependenceGraphBase::print(raw_ostream &OS) const {
+  for (iterator N = begin(), E = end(); N != E; ++N)
+    printNode(OS, *N, getCollapsedLoop(*N));
+  for (unsigned i = 0, e = hashes.size(); i != e; ++i)
+    OS << "  hash " << i << ": " << format("%016" PRIx64, hashes[i]) << "\n";
+}
+
+// LLVM's GraphWriter names nodes by address, which changes from run to run,
+// so the DOT output is written by hand with the node IDs as names.
+void ControlDependenceGraphBase::writeDOT(raw_ostream &OS, const std::string &Title) const {
+  std::string title = DOT::EscapeString(Title);
+  OS << "digraph \"" << title << "\" {\n";
+  OS << "\tlabel=\"" << title << "\";\n\n";
+  for (std::vector<ControlDependenceNode *>::const_iterator N = nodes.begin(), E = nodes.end();
+       N != E; ++N) {
+    ControlDependenceNode *node = *N;
+    OS << "\tNode" << node->getID() << " [shape=record,label=\"{";
+    if (node == root)
+      OS << "ENTRY";
+    else if (node->isRegion())
+      OS << "REGION";
+    else if (node->getBlock()->hasName())
+      OS << DOT::EscapeString(node->getBlock()->getName().str());
+    else
+      OS << "<unnamed>";
+    OS << "}\"];\n";
   }
+  OS << "\n";
+  for (std::vector<ControlDependenceNode *>::const_iterator N = nodes.begin(), E = nodes.end();
+       N != E; ++N) {
+    ControlDependenceNode *node = *N;
+    for (ControlDependenceNode::edge_iterator C = node->begin(), CE = node->end();
+	 C != CE; ++C) {
+      OS << "\tNode" << node->getID() << " -> Node" << (*C)->getID();
+      switch (C.type()) {
+      case ControlDependenceNode::TRUE:  OS << " [label=\"T\"]"; break;
+      case ControlDependenceNode::FALSE: OS << " [label=\"F\"]"; break;
+      case ControlDependenceNode::OTHER: break;
+      }
+      OS << ";\n";
+    }
+  }
+  OS << "}\n";
+}
+
+ControlDependenceGraph::ControlDependenceGraph()
+  : FunctionPass(ID), ControlDependenceGraphBase() {
+  setOptions(ControlDependenceOptions::fromCommandLine());
+}
+
+// Loop information is needed to collapse loops, and lets a function that
+// runs out of budget fall back to a loop-collapsed graph.
+static bool needsLoopInfo() {
+  return CollapseLoops || TimeBudget || MemoryBudget;
+}
+
+void ControlDependenceGraph::addRequiredAnalyses(AnalysisUsage &AU) {
+  if (PruneWithLVI)
+    AU.addRequired<LazyValueInfo>();
+  if (needsLoopInfo())
+    AU.addRequired<LoopInfo>();
+}
+
+void ControlDependenceGraph::getRequiredAnalyses(const Pass &P, LazyValueInfo *&LVI,
+						 LoopInfo *&LI) {
+  LVI = PruneWithLVI ? &P.getAnalysis<LazyValueInfo>() : NULL;
+  LI = needsLoopInfo() ? &P.getAnalysis<LoopInfo>() : NULL;
+}
+
+void ControlDependenceGraph::getAnalysisUsage(AnalysisUsage &AU) const {
+  addRequiredAnalyses(AU);
+  if (UsePostDomTree)
+    AU.addRequired<PostDominatorTree>();
+  AU.setPreservesAll();
+}
+
+bool ControlDependenceGraph::runOnFunction(Function &F) {
+  LazyValueInfo *LVI;
+  LoopInfo *LI;
+  getRequiredAnalyses(*this,LVI,LI);
+  if (UsePostDomTree)
+    graphForFunction(F,getAnalysis<PostDominatorTree>(),LVI);
+  else
+    graphForFunction(F,pdb,LVI,LI);
   return false;
 }
 
-bool ControlDependenceGraphBase::influences(BasicBlock *A, BasicBlock *B) const {
-  const ControlDependenceNode *n = getNode(B);
-  assert(n && "Basic block not in control dependence graph!");
+ControlDependenceGraphs::~ControlDependenceGraphs() {
+  for (std::map<const Function *, ControlDependenceRegions *>::iterator
+	 R = regions.begin(), E = regions.end(); R != E; ++R)
+    delete R->second;
+  regions.clear();
+  graphs.clear();
+}
 
-  std::deque<ControlDependenceNode *> worklist;
-  worklist.insert(worklist.end(), n->parent_begin(), n->parent_end());
+bool ControlDependenceGraphs::runOnModule(Module &M) {
+  ControlDependenceOptions Opts = ControlDependenceOptions::fromCommandLine();
+  regionsOnly = RegionsOnly;
 
-  while (!worklist.empty()) {
-    n = worklist.front();
-    worklist.pop_front();
-    if (n->getBlock() == A) return true;
-    worklist.insert(worklist.end(), n->parent_begin(), n->parent_end());
+  // In regions-only mode the summaries are built in the same scratch graph,
+  // which never holds any nodes.
+  ControlDependenceGraphBase scratch;
+  for (Module::iterator F = M.begin(), E = M.end(); F != E; ++F) {
+    if (F->isDeclaration())
+      continue;
+    ControlDependenceGraphBase &cdg = regionsOnly ? scratch : graphs[F];
+    LazyValueInfo *LVI = PruneWithLVI ? &getAnalysis<LazyValueInfo>(*F) : NULL;
+    LoopInfo *LI = needsLoopInfo() ? &getAnalysis<LoopInfo>(*F) : NULL;
+    cdg.setOptions(Opts);
+    if (regionsOnly) {
+      ControlDependenceRegions *&R = regions[F];
+      if (!R)
+	R = new ControlDependenceRegions();
+      scratch.regionsForFunction(*F,pdb,*R,LVI,LI);
+    } else {
+      cdg.graphForFunction(*F,pdb,LVI,LI);
+    }
   }
-
   return false;
 }
 
-const ControlDependenceNode *ControlDependenceGraphBase::enclosingRegion(BasicBlock *BB) const {
-  if (const ControlDependenceNode *node = this->getNode(BB)) {
-    return node->enclosingRegion();
-  } else {
-    return NULL;
+const ControlDependenceRegions &ControlDependenceGraphs::regionsFor(const Function *F) {
+  ControlDependenceRegions *&R = regions[F];
+  if (!R) {
+    R = new ControlDependenceRegions();
+    if (!regionsOnly)
+      R->summarize(*F,graphs[F]);
   }
+  return *R;
+}
+
+// Summaries already made are printed as they are; the others are made for
+// the occasion, so that printing leaves the pass as it was.
+void ControlDependenceGraphs::print(raw_ostream &OS, const Module *M) const {
+  if (!M)
+    return;
+  for (Module::const_iterator F = M->begin(), E = M->end(); F != E; ++F) {
+    if (F->isDeclaration())
+      continue;
+    std::map<const Function *, ControlDependenceGraphBase>::const_iterator G = graphs.find(F);
+    if (G != graphs.end()) {
+      OS << "Control dependence graph for '" << F->getName() << "':\n";
+      G->second.print(OS);
+    }
+    std::map<const Function *, ControlDependenceRegions *>::const_iterator
+      R = regions.find(F);
+    if (R != regions.end()) {
+      R->second->print(OS,*F);
+    } else if (G != graphs.end()) {
+      ControlDependenceRegions summary;
+      summary.summarize(*F,G->second);
+      summary.print(OS,*F);
+    }
+  }
+}
+
+void ControlDependenceGraphs::getAnalysisUsage(AnalysisUsage &AU) const {
+  if (PruneWithLVI)
+    AU.addRequired<LazyValueInfo>();
+  if (needsLoopInfo())
+    AU.addRequired<LoopInfo>();
+  AU.setPreservesAll();
 }
 
 } // namespace llvm
 
 namespace {
 
-struct ControlDependenceViewer
-  : public DOTGraphTraitsViewer<ControlDependenceGraph, false> {
+std::string getGraphTitle(const Function &F) {
+  return "Control dependence graph for '" + F.getName().str() + "' function";
+}
+
+struct ControlDependenceViewer : public FunctionPass {
   static char ID;
-  ControlDependenceViewer() : 
-    DOTGraphTraitsViewer<ControlDependenceGraph, false>("control-deps", ID) {}
+  ControlDependenceViewer() : FunctionPass(ID) {}
+
+  virtual bool runOnFunction(Function &F) {
+    std::string Filename = "control-deps." + F.getName().str() + ".dot";
+    int FD;
+    Filename = createGraphFilename(Filename, FD);
+    raw_fd_ostream File(FD, /*shouldClose=*/ true);
+    getAnalysis<ControlDependenceGraph>().writeDOT(File, getGraphTitle(F));
+    File.close();
+    DisplayGraph(Filename, false, GraphProgram::DOT);
+    return false;
+  }
+
+  virtual void getAnalysisUsage(AnalysisUsage &AU) const {
+    AU.setPreservesAll();
+    AU.addRequired<ControlDependenceGraph>();
+  }
+};
+
+struct ControlDependencePrinter : public FunctionPass {
+  static char ID;
+  ControlDependencePrinter() : FunctionPass(ID) {}
+
+  virtual bool runOnFunction(Function &F) {
+    std::string Filename = "control-deps." + F.getName().str() + ".dot";
+    errs() << "Writing '" << Filename << "'...";
+
+    std::string ErrorInfo;
+    raw_fd_ostream File(Filename.c_str(), ErrorInfo, sys::fs::F_Text);
+    if (ErrorInfo.empty())
+      getAnalysis<ControlDependenceGraph>().writeDOT(File, getGraphTitle(F));
+    else
+      errs() << "  error opening file for writing!";
+    errs() << "\n";
+    return false;
+  }
+
+  virtual void getAnalysisUsage(AnalysisUsage &AU) const {
+    AU.setPreservesAll();
+    AU.addRequired<ControlDependenceGraph>();
+  }
 };
 
-struct ControlDependencePrinter
-  : public DOTGraphTraitsPrinter<ControlDependenceGraph, false> {
+// The engine alone, instantiated over Function through GraphTraits and given
+// post-dominators by the PostDominatorTree pass. It prints what
+// -function-control-deps prints, so that the two can be checked against each
+// other.
+struct GenericControlDependenceGraphPass : public FunctionPass {
   static char ID;
-  ControlDependencePrinter() :
-    DOTGraphTraitsPrinter<ControlDependenceGraph, false>("control-deps", ID) {}
+  GenericControlDependenceGraphPass() : FunctionPass(ID) {}
+
+  virtual bool runOnFunction(Function &F) {
+    Graph.recalculate(&F, getAnalysis<PostDominatorTree>());
+    return false;
+  }
+
+  virtual void releaseMemory() { Graph.clear(); }
+
+  virtual void print(raw_ostream &OS, const Module *M) const {
+    for (GenericControlDependenceGraph<Function *>::iterator N = Graph.begin(),
+	   E = Graph.end(); N != E; ++N)
+      printNode(OS, *N, false);
+  }
+
+  virtual void getAnalysisUsage(AnalysisUsage &AU) const {
+    AU.setPreservesAll();
+    AU.addRequired<PostDominatorTree>();
+  }
+
+private:
+  GenericControlDependenceGraph<Function *> Graph;
+};
+
+// Prints, for every block, the nodes its node depends on, transitively, in
+// post-order of the inverse graph walked from that node. The inverse graph
+// has no entry node, so each walk starts at a block's own node.
+struct ControlDependenceAncestors : public FunctionPass {
+  static char ID;
+  ControlDependenceAncestors() : FunctionPass(ID), Graph(NULL) {}
+
+  virtual bool runOnFunction(Function &F) {
+    Graph = &getAnalysis<ControlDependenceGraph>();
+    return false;
+  }
+
+  virtual void print(raw_ostream &OS, const Module *M) const {
+    for (ControlDependenceGraphBase::iterator N = Graph->begin(), E = Graph->end();
+	 N != E; ++N) {
+      if ((*N)->isRegion())
+	continue;
+      OS << "  " << (*N)->getID() << " ";
+      if ((*N)->getBlock()->hasName())
+	OS << (*N)->getBlock()->getName();
+      else
+	OS << "<unnamed>";
+      OS << ":";
+      Inverse<ControlDependenceNode *> G(*N);
+      for (po_iterator<Inverse<ControlDependenceNode *> > I = po_begin(G), IE = po_end(G);
+	   I != IE; ++I)
+	OS << " " << (*I)->getID();
+      OS << "\n";
+    }
+  }
+
+  virtual void getAnalysisUsage(AnalysisUsage &AU) const {
+    AU.setPreservesAll();
+    AU.addRequired<ControlDependenceGraph>();
+  }
+
+private:
+  const ControlDependenceGraph *Graph;
+};
+
+// Prints, for every block, the blocks it controls. The sets are first
+// filled from several threads at once, as clients sharing a graph do, and
+// then printed from the cache.
+struct ControlDependenceControlled : public FunctionPass {
+  static char ID;
+  ControlDependenceControlled() : FunctionPass(ID), function(NULL), Graph(NULL) {}
+
+  virtual bool runOnFunction(Function &F) {
+    function = &F;
+    Graph = &getAnalysis<ControlDependenceGraph>();
+    std::vector<const BasicBlock *> blocks;
+    for (Function::const_iterator BB = F.begin(), E = F.end(); BB != E; ++BB)
+      if (Graph->getNode(BB))
+	blocks.push_back(BB);
+    std::vector<std::thread> pool;
+    for (unsigned i = 0; i != 4; ++i)
+      pool.push_back(std::thread(&ControlDependenceControlled::query, Graph, &blocks));
+    for (unsigned i = 0, e = pool.size(); i != e; ++i)
+      pool[i].join();
+    return false;
+  }
+
+  virtual void print(raw_ostream &OS, const Module *M) const {
+    OS << "Controlled blocks for '" << function->getName() << "':\n";
+    for (Function::const_iterator BB = function->begin(), E = function->end(); BB != E; ++BB) {
+      if (!Graph->getNode(BB))
+	continue;
+      OS << "  ";
+      BB->printAsOperand(OS, false);
+      OS << ":";
+      ArrayRef<BasicBlock *> controlled = Graph->controlledBlocks(BB);
+      for (unsigned i = 0, e = controlled.size(); i != e; ++i) {
+	OS << ' ';
+	controlled[i]->printAsOperand(OS, false);
+      }
+      OS << "\n";
+    }
+  }
+
+  virtual void getAnalysisUsage(AnalysisUsage &AU) const {
+    AU.setPreservesAll();
+    AU.addRequired<ControlDependenceGraph>();
+  }
+
+private:
+  const Function *function;
+  const ControlDependenceGraph *Graph;
+
+  static void query(const ControlDependenceGraph *G,
+		    const std::vector<const BasicBlock *> *blocks) {
+    for (unsigned i = 0, e = blocks->size(); i != e; ++i)
+      G->controlledBlocks((*blocks)[i]);
+  }
+};
+
+// Builds the loop-collapsed graph of every function, then expands each of
+// its loops, and theirs in turn. It prints the graph of the function and then
+// that of every loop, outermost first.
+struct ControlDependenceLoops : public FunctionPass {
+  static char ID;
+  ControlDependenceLoops() : FunctionPass(ID) {}
+
+  virtual bool runOnFunction(Function &F) {
+    ControlDependenceOptions Opts = ControlDependenceOptions::fromCommandLine();
+    Opts.CollapseLoops = true;
+    Graph.setOptions(Opts);
+    Graph.graphForFunction(F, pdb, NULL, &getAnalysis<LoopInfo>());
+    expandLoops(Graph);
+    for (unsigned i = 0; i != Loops.size(); ++i)
+      expandLoops(*Loops[i].second);
+    return false;
+  }
+
+  virtual void releaseMemory() {
+    Loops.clear();
+    Graph.releaseMemory();
+  }
+
+  virtual void print(raw_ostream &OS, const Module *M) const {
+    Graph.print(OS);
+    for (unsigned i = 0, e = Loops.size(); i != e; ++i) {
+      OS << "loop %" << Loops[i].first->getHeader()->getName() << ":\n";
+      Loops[i].second->print(OS);
+    }
+  }
+
+  virtual void getAnalysisUsage(AnalysisUsage &AU) const {
+    AU.setPreservesAll();
+    AU.addRequired<LoopInfo>();
+  }
+
+private:
+  PostDominatorBuilder pdb;
+  ControlDependenceGraphBase Graph;
+  std::vector<std::pair<const ControlDependenceLoop *, ControlDependenceGraphBase *> > Loops;
+
+  void expandLoops(ControlDependenceGraphBase &G) {
+    for (ControlDependenceGraphBase::iterator N = G.begin(), E = G.end(); N != E; ++N)
+      if (const ControlDependenceLoop *L = G.getCollapsedLoop(*N))
+	Loops.push_back(std::make_pair(L, &G.expandLoop(L, pdb)));
+  }
+};
+
+// Records what a graph reports to its observers, and checks that hashes are
+// still readable when nodes are removed.
+class ObserverLog : public ControlDependenceObserver {
+public:
+  enum EventKind { Added, Invalidated, Removed, RemovedWithoutHash };
+  typedef std::pair<EventKind, unsigned> event;
+
+  explicit ObserverLog(const ControlDependenceGraphBase &G) : Graph(G) {}
+
+  virtual void nodeAdded(const ControlDependenceNode *N) {
+    Events.push_back(event(Added, N->getID()));
+    Hashes[N->getID()] = Graph.getHash(N);
+  }
+  virtual void graphInvalidated(const ControlDependenceGraphBase &G) {
+    Events.push_back(event(Invalidated, 0));
+  }
+  virtual void nodeRemoved(const ControlDependenceNode *N) {
+    bool kept = Hashes.lookup(N->getID()) == Graph.getHash(N);
+    Events.push_back(event(kept ? Removed : RemovedWithoutHash, N->getID()));
+  }
+
+  std::vector<event> Events;
+
+private:
+  const ControlDependenceGraphBase &Graph;
+  DenseMap<unsigned, uint64_t> Hashes;
+};
+
+// Builds the graph of every function twice and then releases it, and prints
+// the notices its observer received. Consecutive notices of the same kind
+// share a line.
+struct ControlDependenceObservers : public FunctionPass {
+  static char ID;
+  ControlDependenceObservers() : FunctionPass(ID), Log(Graph) {}
+
+  virtual bool runOnFunction(Function &F) {
+    Log.Events.clear();
+    Graph.setOptions(ControlDependenceOptions::fromCommandLine());
+    Graph.addObserver(&Log);
+    Graph.graphForFunction(F, pdb);
+    Graph.graphForFunction(F, pdb);
+    Graph.releaseMemory();
+    Graph.removeObserver(&Log);
+    return false;
+  }
+
+  virtual void print(raw_ostream &OS, const Module *M) const {
+    static const char *const Names[] = {
+      "added", "invalidated", "removed", "removed without hash"
+    };
+    for (unsigned i = 0, e = Log.Events.size(); i != e; ++i) {
+      ObserverLog::EventKind kind = Log.Events[i].first;
+      if (i == 0 || kind != Log.Events[i-1].first)
+	OS << (i ? "\n" : "") << "  " << Names[kind]
+	   << (kind == ObserverLog::Invalidated ? "" : ":");
+      if (kind != ObserverLog::Invalidated)
+	OS << " " << Log.Events[i].second;
+    }
+    if (!Log.Events.empty())
+      OS << "\n";
+  }
+
+  virtual void getAnalysisUsage(AnalysisUsage &AU) const {
+    AU.setPreservesAll();
+  }
+
+private:
+  PostDominatorBuilder pdb;
+  ControlDependenceGraphBase Graph;
+  ObserverLog Log;
 };
 
 } // end anonymous namespace
@@ -350,3 +1661,28 @@ char ControlDependencePrinter::ID = 0;
 static RegisterPass<ControlDependencePrinter> Printer("print-control-deps",
 						      "Print the control dependency graph as a 'dot' file",
 						      true, true);
+
+char GenericControlDependenceGraphPass::ID = 0;
+static RegisterPass<GenericControlDependenceGraphPass> GenericGraph("generic-control-deps",
+								   "Compute control dependency graphs with the generic engine",
+								   true, true);
+
+char ControlDependenceAncestors::ID = 0;
+static RegisterPass<ControlDependenceAncestors> Ancestors("control-deps-ancestors",
+							 "Print the transitive control dependences of every block",
+							 true, true);
+
+char ControlDependenceControlled::ID = 0;
+static RegisterPass<ControlDependenceControlled> Controlled("control-deps-controlled",
+							  "Print the blocks every block controls",
+							  true, true);
+
+char ControlDependenceLoops::ID = 0;
+static RegisterPass<ControlDependenceLoops> Loops("control-deps-loops",
+						  "Print the loop-collapsed control dependency graph and its loops",
+						  true, true);
+
+char ControlDependenceObservers::ID = 0;
+static RegisterPass<ControlDependenceObservers> Observers("control-deps-observers",
+							  "Print the notices control dependency graph observers receive",
+							  true, true);
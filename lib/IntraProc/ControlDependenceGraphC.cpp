@@ -0,0 +1,162 @@
+//===- IntraProc/ControlDependenceGraphC.cpp --------------------*- C++ -*-===//
+//
+//                      Static Program Analysis for LLVM
+//
+// This file is distributed under a Modified BSD License (see LICENSE.TXT).
+//
+//===----------------------------------------------------------------------===//
+//
+// This file implements the C interface to control dependence graphs. Each
+// handle owns a graph together with a flat copy of its structure, made once
+// when the graph is built.
+//
+//===----------------------------------------------------------------------===//
+
+#include "IntraProc-c/ControlDependenceGraph.h"
+#include "IntraProc/ControlDependenceGraph.h"
+
+#include "llvm/ADT/DenseMap.h"
+#include "llvm/IR/Function.h"
+#include "llvm/Support/CBindingWrapping.h"
+
+#include <vector>
+
+using namespace llvm;
+
+namespace {
+
+struct FrozenGraph {
+  ControlDependenceGraphBase Graph;
+  std::vector<BasicBlock *> Blocks;
+  std::vector<uint8_t> NodeKinds;
+  std::vector<int32_t> BlockIndices;
+  std::vector<uint32_t> EdgeOffsets;
+  std::vector<uint32_t> EdgeTargets;
+  std::vector<uint8_t> EdgeLabels;
+  std::vector<uint64_t> Hashes;
+
+  void freeze();
+};
+
+} // end anonymous namespace
+
+DEFINE_SIMPLE_CONVERSION_FUNCTIONS(FrozenGraph, LLVMControlDependenceGraphRef)
+
+template <typename T>
+static const T *arrayOf(const std::vector<T> &V) {
+  return V.empty() ? NULL : &V[0];
+}
+
+static uint8_t getLabel(ControlDependenceNode::EdgeType T) {
+  switch (T) {
+  case ControlDependenceNode::TRUE:  return LLVMCDEdgeTrue;
+  case ControlDependenceNode::FALSE: return LLVMCDEdgeFalse;
+  default:                           return LLVMCDEdgeOther;
+  }
+}
+
+void FrozenGraph::freeze() {
+  DenseMap<const BasicBlock *, int32_t> position;
+  for (unsigned i = 0, e = Blocks.size(); i != e; ++i)
+    position[Blocks[i]] = i;
+
+  unsigned n = Graph.getNumNodes();
+  NodeKinds.resize(n);
+  BlockIndices.resize(n);
+  EdgeOffsets.resize(n + 1);
+  EdgeOffsets[0] = 0;
+  for (unsigned i = 0; i != n; ++i) {
+    ControlDependenceNode *N = Graph.getNodeByID(i);
+    NodeKinds[i] = N->isRegion() ? LLVMCDNodeRegion : LLVMCDNodeBlock;
+    BlockIndices[i] = N->isRegion() ? -1 : position.lookup(N->getBlock());
+    // The edge iterator visits true, false and other children in turn, each
+    // set ordered by ID, which is the order the view promises.
+    for (ControlDependenceNode::edge_iterator C = N->begin(), CE = N->end(); C != CE; ++C) {
+      uint8_t label = getLabel(C.type());
+      assert((EdgeTargets.size() == EdgeOffsets[i] || label > EdgeLabels.back() ||
+	      (label == EdgeLabels.back() && (*C)->getID() > EdgeTargets.back())) &&
+	     "Edges must be ordered by label and then by target!");
+      EdgeTargets.push_back((*C)->getID());
+      EdgeLabels.push_back(label);
+    }
+    EdgeOffsets[i+1] = EdgeTargets.size();
+  }
+
+  if (Graph.getOptions().HashRegions) {
+    Hashes.resize(n);
+    for (unsigned i = 0; i != n; ++i)
+      Hashes[i] = Graph.getHash(Graph.getNodeByID(i));
+  }
+}
+
+LLVMControlDependenceGraphRef
+LLVMCreateControlDependenceGraph(LLVMValueRef Fn, unsigned Flags,
+                                 unsigned TimeBudgetMS, size_t MemoryBudget) {
+  Function *F = unwrap<Function>(Fn);
+  ControlDependenceOptions Opts;
+  Opts.PruneInfeasibleEdges = Flags & LLVMCDPruneInfeasibleEdges;
+  Opts.HashRegions = Flags & LLVMCDHashRegions;
+  Opts.TimeBudgetMS = TimeBudgetMS;
+  Opts.MemoryBudget = MemoryBudget;
+
+  FrozenGraph *G = new FrozenGraph();
+  for (Function::iterator BB = F->begin(), E = F->end(); BB != E; ++BB)
+    G->Blocks.push_back(BB);
+  PostDominatorBuilder pdb;
+  G->Graph.setOptions(Opts);
+  G->Graph.graphForFunction(*F,pdb);
+  G->freeze();
+  return wrap(G);
+}
+
+void LLVMDisposeControlDependenceGraph(LLVMControlDependenceGraphRef G) {
+  delete unwrap(G);
+}
+
+void LLVMGetControlDependenceGraphView(LLVMControlDependenceGraphRef GR,
+                                       LLVMCDGraphView *View) {
+  FrozenGraph *G = unwrap(GR);
+  View->NumNodes = G->NodeKinds.size();
+  View->NumEdges = G->EdgeTargets.size();
+  View->NodeKinds = arrayOf(G->NodeKinds);
+  View->BlockIndices = arrayOf(G->BlockIndices);
+  View->EdgeOffsets = arrayOf(G->EdgeOffsets);
+  View->EdgeTargets = arrayOf(G->EdgeTargets);
+  View->EdgeLabels = arrayOf(G->EdgeLabels);
+  View->Hashes = arrayOf(G->Hashes);
+}
+
+LLVMBool LLVMIsControlDependenceGraphApproximate(LLVMControlDependenceGraphRef G) {
+  return unwrap(G)->Graph.isApproximate();
+}
+
+int32_t LLVMGetControlDependenceNode(LLVMControlDependenceGraphRef G,
+                                     LLVMBasicBlockRef BB) {
+  const ControlDependenceGraphBase &CDG = unwrap(G)->Graph;
+  const ControlDependenceNode *N = CDG.getNode(unwrap(BB));
+  return N ? (int32_t)N->getID() : -1;
+}
+
+LLVMBasicBlockRef LLVMGetControlDependenceNodeBlock(LLVMControlDependenceGraphRef G,
+                                                    uint32_t Node) {
+  const ControlDependenceGraphBase &CDG = unwrap(G)->Graph;
+  if (Node >= CDG.getNumNodes())
+    return NULL;
+  return wrap(CDG.getNodeByID(Node)->getBlock());
+}
+
+uint32_t LLVMGetEnclosingControlDependenceRegion(LLVMControlDependenceGraphRef G,
+                                                 LLVMBasicBlockRef BB) {
+  const ControlDependenceNode *R = unwrap(G)->Graph.enclosingRegion(unwrap(BB));
+  return R ? R->getID() : LLVMCDNoRegion;
+}
+
+LLVMBool LLVMControlDependenceControls(LLVMControlDependenceGraphRef G,
+                                       LLVMBasicBlockRef A, LLVMBasicBlockRef B) {
+  return unwrap(G)->Graph.controls(unwrap(A), unwrap(B));
+}
+
+LLVMBool LLVMControlDependenceInfluences(LLVMControlDependenceGraphRef G,
+                                         LLVMBasicBlockRef A, LLVMBasicBlockRef B) {
+  return unwrap(G)->Graph.influences(unwrap(A), unwrap(B));
+}
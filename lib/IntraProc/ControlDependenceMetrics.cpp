@@ -0,0 +1,218 @@
+//===- IntraProc/ControlDependenceMetrics.cpp -------------------*- C++ -*-===//
+//
+//                      Static Program Analysis for LLVM
+//
+// This file is distributed under a Modified BSD License (see LICENSE.TXT).
+//
+//===----------------------------------------------------------------------===//
+//
+// This file defines the ControlDependenceMetrics pass, which derives code
+// complexity metrics from the control dependence graph of every function of
+// a module in one linear walk per graph, and writes them as CSV. Functions
+// are analyzed on several threads at once.
+//
+//===----------------------------------------------------------------------===//
+
+#include "IntraProc/ControlDependenceMetrics.h"
+#include "IntraProc/ControlDependenceGraph.h"
+
+#include "llvm/IR/Function.h"
+#include "llvm/IR/Module.h"
+#include "llvm/Support/CommandLine.h"
+#include "llvm/Support/ErrorHandling.h"
+#include "llvm/Support/FileSystem.h"
+#include "llvm/Support/MutexGuard.h"
+#include "llvm/Support/raw_ostream.h"
+
+#include <algorithm>
+#include <thread>
+#include <utility>
+
+using namespace llvm;
+
+static cl::opt<std::string>
+MetricsFile("cdg-metrics-output", cl::value_desc("filename"),
+            cl::desc("Write the control dependence metrics CSV to <filename>"));
+
+static cl::opt<unsigned>
+MetricsThreads("cdg-metrics-threads", cl::init(0),
+               cl::desc("Compute control dependence metrics on this many "
+                        "threads (default: one per core)"));
+
+namespace {
+
+// Hands out the functions of a module to the threads computing their
+// metrics. Each thread builds its graphs in a graph of its own, and the
+// results land in module order whichever thread computes them.
+class MetricsWorkers {
+public:
+  MetricsWorkers(const std::vector<Function *> &functions,
+                 std::vector<ControlDependenceMetrics::Metrics> &results,
+                 const ControlDependenceOptions &options)
+    : functions(functions), results(results), options(options), next(0) {}
+
+  void run();
+
+private:
+  const std::vector<Function *> &functions;
+  std::vector<ControlDependenceMetrics::Metrics> &results;
+  ControlDependenceOptions options;
+  sys::Mutex Lock;
+  unsigned next;
+};
+
+} // end anonymous namespace
+
+void MetricsWorkers::run() {
+  ControlDependenceGraphBase G;
+  G.setOptions(options);
+  PostDominatorBuilder pdb;
+  for (;;) {
+    unsigned i;
+    {
+      MutexGuard Guard(Lock);
+      if (next == functions.size())
+	return;
+      i = next++;
+    }
+    G.graphForFunction(*functions[i],pdb);
+    results[i] = ControlDependenceMetrics::compute(*functions[i], G);
+    G.releaseMemory();
+  }
+}
+
+static unsigned fanOutBucket(unsigned n) {
+  if (n <= 2)
+    return n - 1;
+  if (n <= 4)
+    return 2;
+  return n <= 8 ? 3 : 4;
+}
+
+namespace llvm {
+
+ControlDependenceMetrics::Metrics
+ControlDependenceMetrics::compute(const Function &F, const ControlDependenceGraphBase &G) {
+  Metrics M;
+  M.F = &F;
+  M.Blocks = F.size();
+  M.Regions = M.Decisions = M.MaxDepth = M.MaxFanOut = M.LargestClass = 0;
+  std::fill(M.FanOut, M.FanOut + 5, 0);
+  M.Approximate = G.isApproximate();
+
+  unsigned n = G.getNumNodes();
+  for (unsigned i = 0; i != n; ++i) {
+    ControlDependenceNode *N = const_cast<ControlDependenceNode *>(G.getNodeByID(i));
+    unsigned children = N->getNumChildren();
+    if (N->isRegion()) {
+      ++M.Regions;
+      unsigned blocks = 0;
+      for (ControlDependenceNode::edge_iterator C = N->begin(), CE = N->end(); C != CE; ++C)
+	if (!(*C)->isRegion())
+	  ++blocks;
+      M.LargestClass = std::max(M.LargestClass, blocks);
+    } else if (children) {
+      ++M.Decisions;
+      M.MaxFanOut = std::max(M.MaxFanOut, children);
+      ++M.FanOut[fanOutBucket(children)];
+    }
+  }
+  if (!n)
+    return M;
+
+  // Order the nodes reachable from the root by depth-first postorder. Edges
+  // to nodes still on the stack close loops and are left out, so depths
+  // propagate along the rest in reverse postorder.
+  enum { Unseen, Open, Done };
+  std::vector<unsigned char> state(n, Unseen);
+  std::vector<unsigned> postorder;
+  postorder.reserve(n);
+  typedef std::pair<ControlDependenceNode *, ControlDependenceNode::edge_iterator> Frame;
+  ControlDependenceNode *root = const_cast<ControlDependenceNode *>(G.getRoot());
+  std::vector<Frame> stack(1, Frame(root, root->begin()));
+  state[root->getID()] = Open;
+  while (!stack.empty()) {
+    Frame &top = stack.back();
+    if (top.second == top.first->end()) {
+      state[top.first->getID()] = Done;
+      postorder.push_back(top.first->getID());
+      stack.pop_back();
+      continue;
+    }
+    ControlDependenceNode *C = *top.second++;
+    if (state[C->getID()] == Unseen) {
+      state[C->getID()] = Open;
+      stack.push_back(Frame(C, C->begin()));
+    }
+  }
+
+  std::vector<unsigned> rpoIndex(n, 0), depth(n, 0);
+  for (unsigned i = 0, e = postorder.size(); i != e; ++i)
+    rpoIndex[postorder[i]] = e - i;
+  for (unsigned i = postorder.size(); i-- != 0; ) {
+    ControlDependenceNode *N = const_cast<ControlDependenceNode *>(G.getNodeByID(postorder[i]));
+    unsigned d = depth[N->getID()] + !N->isRegion();
+    for (ControlDependenceNode::edge_iterator C = N->begin(), CE = N->end(); C != CE; ++C)
+      if (rpoIndex[(*C)->getID()] > rpoIndex[N->getID()])
+	depth[(*C)->getID()] = std::max(depth[(*C)->getID()], d);
+    if (!N->isRegion())
+      M.MaxDepth = std::max(M.MaxDepth, depth[N->getID()]);
+  }
+  return M;
+}
+
+bool ControlDependenceMetrics::runOnModule(Module &M) {
+  std::vector<Function *> functions;
+  for (Module::iterator F = M.begin(), E = M.end(); F != E; ++F)
+    if (!F->isDeclaration())
+      functions.push_back(F);
+  metrics.resize(functions.size());
+
+  // Loops cannot be collapsed without LoopInfo, which is not safe to compute
+  // on several threads, and hashes are not needed. The time budget is off
+  // too: it is measured against the wall clock, so workers contending for
+  // the machine would be charged for each other's time.
+  ControlDependenceOptions options = ControlDependenceOptions::fromCommandLine();
+  options.CollapseLoops = false;
+  options.HashRegions = false;
+  options.TimeBudgetMS = 0;
+
+  unsigned threads = MetricsThreads ? MetricsThreads : std::thread::hardware_concurrency();
+  threads = std::max(1U, std::min<unsigned>(threads, functions.size()));
+  MetricsWorkers workers(functions, metrics, options);
+  std::vector<std::thread> pool;
+  for (unsigned i = 1; i < threads; ++i)
+    pool.push_back(std::thread(&MetricsWorkers::run, &workers));
+  workers.run();
+  for (unsigned i = 0, e = pool.size(); i != e; ++i)
+    pool[i].join();
+
+  if (!MetricsFile.empty()) {
+    std::string Err;
+    raw_fd_ostream OS(MetricsFile.c_str(), Err, sys::fs::F_Text);
+    if (!Err.empty())
+      report_fatal_error(Twine("Cannot open metrics file '") + MetricsFile + "': " + Err);
+    print(OS, &M);
+  }
+  return false;
+}
+
+void ControlDependenceMetrics::print(raw_ostream &OS, const Module *) const {
+  OS << "function,blocks,regions,decisions,max_depth,max_fanout,fanout_1,fanout_2,"
+     << "fanout_3_4,fanout_5_8,fanout_9_plus,largest_class,approximate\n";
+  for (unsigned i = 0, e = metrics.size(); i != e; ++i) {
+    const Metrics &M = metrics[i];
+    OS << M.F->getName() << ',' << M.Blocks << ',' << M.Regions << ','
+       << M.Decisions << ',' << M.MaxDepth << ',' << M.MaxFanOut;
+    for (unsigned b = 0; b != 5; ++b)
+      OS << ',' << M.FanOut[b];
+    OS << ',' << M.LargestClass << ',' << M.Approximate << '\n';
+  }
+}
+
+} // namespace llvm
+
+char ControlDependenceMetrics::ID = 0;
+static RegisterPass<ControlDependenceMetrics> Metrics("cdg-metrics",
+						      "Compute control dependence complexity metrics",
+						      true, true);
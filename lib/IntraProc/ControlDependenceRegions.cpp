@@ -0,0 +1,195 @@
+//===- IntraProc/ControlDependenceRegions.cpp -------------------*- C++ -*-===//
+//
+//                      Static Program Analysis for LLVM
+//
+// This file is distributed under a Modified BSD License (see LICENSE.TXT).
+//
+//===----------------------------------------------------------------------===//
+//
+// This file defines the ControlDependenceRegions class, a compact summary of
+// a control dependence graph that keeps only its regions: the region each
+// block belongs to, the branches that control each region, and the tree the
+// regions form. It answers enclosing region queries for a fraction of the
+// memory of the full graph.
+//
+//===----------------------------------------------------------------------===//
+
+#include "IntraProc/ControlDependenceRegions.h"
+
+#include "llvm/IR/Function.h"
+#include "llvm/Support/ErrorHandling.h"
+#include "llvm/Support/raw_ostream.h"
+
+#include <algorithm>
+
+using namespace llvm;
+
+namespace llvm {
+
+const ControlDependenceRegions::RegionID ControlDependenceRegions::NoRegion;
+
+// Return the type of the edge from P to C.
+static ControlDependenceNode::EdgeType edgeTypeTo(ControlDependenceNode *P,
+                                                  const ControlDependenceNode *C) {
+  for (ControlDependenceNode::edge_iterator I = P->begin(), E = P->end(); I != E; ++I)
+    if (*I == C)
+      return I.type();
+  llvm_unreachable("Not a child of its parent!");
+}
+
+static bool compareKeys(const std::pair<unsigned, ControlDependenceRegions::Controller> &A,
+                        const std::pair<unsigned, ControlDependenceRegions::Controller> &B) {
+  return A.first < B.first;
+}
+
+void ControlDependenceRegions::clear() {
+  approximate = false;
+  regionOf.clear();
+  parentRegion.clear();
+  controllerBegin.clear();
+  controllers.clear();
+  loopBodies.clear();
+}
+
+void ControlDependenceRegions::summarize(const Function &F,
+                                         const ControlDependenceGraphBase &G) {
+  clear();
+  approximate = G.isApproximate();
+
+  // Number the regions in the order of their first block, root first.
+  DenseMap<const ControlDependenceNode *, RegionID> ids;
+  std::vector<const ControlDependenceNode *> regions;
+  if (const ControlDependenceNode *root = G.getRoot()) {
+    ids[root] = 0;
+    regions.push_back(root);
+  }
+  for (Function::const_iterator BB = F.begin(), E = F.end(); BB != E; ++BB) {
+    const ControlDependenceNode *N = G.getNode(BB);
+    if (!N)
+      continue;
+    const ControlDependenceNode *R = N->enclosingRegion();
+    std::pair<DenseMap<const ControlDependenceNode *, RegionID>::iterator, bool> I =
+      ids.insert(std::make_pair(R, (RegionID)regions.size()));
+    if (I.second)
+      regions.push_back(R);
+    regionOf[BB] = I.first->second;
+    if (I.first->second == getRootRegion() && !G.alwaysExecutes(BB))
+      loopBodies.insert(BB);
+  }
+
+  // Controllers are sorted by the ID of their branch's node, which follows
+  // function order, and then by label.
+  typedef std::pair<unsigned, Controller> keyed_controller;
+  std::vector<keyed_controller> sorted;
+  controllerBegin.reserve(regions.size() + 1);
+  controllerBegin.push_back(0);
+  for (RegionID R = 0, E = regions.size(); R != E; ++R) {
+    if (!approximate) {
+      sorted.clear();
+      for (ControlDependenceNode::const_node_iterator P = regions[R]->parent_begin(),
+	     PE = regions[R]->parent_end(); P != PE; ++P) {
+	// Look through the regions that split a branch's true or false edges.
+	ControlDependenceNode *branch = *P;
+	const ControlDependenceNode *child = regions[R];
+	Controller C;
+	if (branch == G.getRoot()) {
+	  C.Branch = NULL;
+	  C.Type = ControlDependenceNode::OTHER;
+	} else {
+	  if (branch->isRegion()) {
+	    child = branch;
+	    branch = *branch->parent_begin();
+	  }
+	  C.Branch = branch->getBlock();
+	  C.Type = edgeTypeTo(branch, child);
+	}
+	sorted.push_back(std::make_pair(3 * branch->getID() + C.Type, C));
+      }
+      std::sort(sorted.begin(), sorted.end(), compareKeys);
+      for (unsigned i = 0, e = sorted.size(); i != e; ++i)
+	controllers.push_back(sorted[i].second);
+    }
+    controllerBegin.push_back(controllers.size());
+  }
+  buildTree();
+}
+
+// Loops make the regions and their controllers cyclic, so the region tree
+// is the breadth-first spanning tree from the root along controller edges.
+void ControlDependenceRegions::buildTree() {
+  unsigned n = controllerBegin.size() - 1;
+  std::vector<unsigned> childBegin(n + 1, 0), children(controllers.size());
+  for (RegionID R = 0; R != n; ++R)
+    for (controller_iterator C = controller_begin(R), CE = controller_end(R); C != CE; ++C)
+      ++childBegin[controllingRegion(*C) + 1];
+  for (RegionID R = 0; R != n; ++R)
+    childBegin[R+1] += childBegin[R];
+  std::vector<unsigned> fill(childBegin.begin(), childBegin.end() - 1);
+  for (RegionID R = 0; R != n; ++R)
+    for (controller_iterator C = controller_begin(R), CE = controller_end(R); C != CE; ++C)
+      children[fill[controllingRegion(*C)]++] = R;
+
+  parentRegion.assign(n, NoRegion);
+  if (n == 0)
+    return;
+  std::vector<bool> seen(n, false);
+  std::vector<RegionID> queue;
+  queue.push_back(getRootRegion());
+  seen[getRootRegion()] = true;
+  for (unsigned head = 0; head != queue.size(); ++head) {
+    RegionID R = queue[head];
+    for (unsigned i = childBegin[R]; i != childBegin[R+1]; ++i) {
+      RegionID C = children[i];
+      if (!seen[C]) {
+	seen[C] = true;
+	parentRegion[C] = R;
+	queue.push_back(C);
+      }
+    }
+  }
+  for (RegionID R = 0; R != n; ++R)
+    if (!seen[R])
+      parentRegion[R] = getRootRegion();
+}
+
+void ControlDependenceRegions::print(raw_ostream &OS, const Function &F) const {
+  OS << "Control dependence regions of function '" << F.getName() << "'";
+  if (approximate)
+    OS << " (approximate)";
+  OS << ":\n";
+
+  std::vector<std::vector<const BasicBlock *> > blocks(getNumRegions());
+  for (Function::const_iterator BB = F.begin(), E = F.end(); BB != E; ++BB) {
+    RegionID R = enclosingRegion(BB);
+    if (R != NoRegion)
+      blocks[R].push_back(BB);
+  }
+
+  for (RegionID R = 0, E = getNumRegions(); R != E; ++R) {
+    OS << "  region " << R;
+    if (getParentRegion(R) != NoRegion)
+      OS << ", parent " << getParentRegion(R);
+    OS << ":";
+    for (std::vector<const BasicBlock *>::const_iterator BB = blocks[R].begin(),
+	   BE = blocks[R].end(); BB != BE; ++BB) {
+      OS << " ";
+      (*BB)->printAsOperand(OS, false);
+    }
+    OS << "\n";
+    for (controller_iterator C = controller_begin(R), CE = controller_end(R); C != CE; ++C) {
+      OS << "    controlled by ";
+      if (!C->Branch) {
+	OS << "function entry\n";
+	continue;
+      }
+      C->Branch->printAsOperand(OS, false);
+      switch (C->Type) {
+      case ControlDependenceNode::TRUE:  OS << " (true)\n";  break;
+      case ControlDependenceNode::FALSE: OS << " (false)\n"; break;
+      case ControlDependenceNode::OTHER: OS << " (other)\n"; break;
+      }
+    }
+  }
+}
+
+} // namespace llvm
@@ -0,0 +1,262 @@
+//===- IntraProc/DivergenceAnalysis.cpp -------------------------*- C++ -*-===//
+//
+//                      Static Program Analysis for LLVM
+//
+// This file is distributed under a Modified BSD License (see LICENSE.TXT).
+//
+//===----------------------------------------------------------------------===//
+//
+// This file defines the DivergenceAnalysis class, which finds the values,
+// branches and join points that differ between the threads of an SPMD
+// program, or between the lanes of a vectorized loop. Divergence spreads
+// from seed values through data dependences and, at divergent branches,
+// through the control dependence graph: every join point of a divergent
+// branch merges values that differ between the threads that took different
+// paths to it.
+//
+//===----------------------------------------------------------------------===//
+
+#include "IntraProc/DivergenceAnalysis.h"
+
+#include "llvm/ADT/BitVector.h"
+#include "llvm/ADT/DenseMap.h"
+#include "llvm/ADT/SmallVector.h"
+#include "llvm/Analysis/LoopInfo.h"
+#include "llvm/IR/CFG.h"
+#include "llvm/IR/Instructions.h"
+#include "llvm/Support/CommandLine.h"
+#include "llvm/Support/raw_ostream.h"
+
+#include <string>
+
+using namespace llvm;
+
+static cl::list<std::string>
+DivergentSources("divergent-source", cl::ZeroOrMore, cl::value_desc("function"),
+                 cl::desc("Print divergence for threads that differ in the results "
+                          "of calls to <function> (default: get_local_id and "
+                          "get_global_id)"));
+
+namespace llvm {
+
+bool DivergenceAnalysis::inScope(const BasicBlock *BB) const {
+  return !scope || scope->contains(BB);
+}
+
+void DivergenceAnalysis::push(const Value *V) {
+  if (const Instruction *I = dyn_cast<Instruction>(V))
+    if (!inScope(I->getParent()))
+      return;
+  if (divergent.insert(V).second)
+    worklist.push_back(V);
+}
+
+void DivergenceAnalysis::markDivergent(const Value *V) {
+  push(V);
+  propagate();
+}
+
+void DivergenceAnalysis::analyzeLoop(const Loop *L) {
+  scope = L;
+  for (BasicBlock::const_iterator I = L->getHeader()->begin(); isa<PHINode>(I); ++I)
+    push(I);
+  propagate();
+}
+
+void DivergenceAnalysis::propagate() {
+  while (!worklist.empty()) {
+    const Value *V = worklist.back();
+    worklist.pop_back();
+    for (Value::const_user_iterator U = V->user_begin(), E = V->user_end(); U != E; ++U) {
+      const Instruction *I = dyn_cast<Instruction>(*U);
+      if (!I)
+	continue;
+      push(I);
+      if (const TerminatorInst *T = dyn_cast<TerminatorInst>(I))
+	if (T->getNumSuccessors() > 1 && inScope(T->getParent()))
+	  branchDiverges(T->getParent());
+    }
+  }
+}
+
+// Threads that leave B along different edges meet again at the blocks that
+// more than one successor of B reaches. Those paths run through the blocks B
+// controls, which the control dependence graph holds below B's node, and end
+// at the first blocks B does not control, such as its immediate
+// post-dominator; so only those blocks are walked.
+void DivergenceAnalysis::branchDiverges(const BasicBlock *B) {
+  if (divergentBranches.count(B))
+    return;
+  divergentBranches.insert(B);
+
+  const ControlDependenceNode *BN = G.getNode(B);
+  if (!BN)
+    return;
+  const BitVector &controlled = G.controlledNodes(B);
+  // The other blocks of a collapsed loop share B's node, and may join too.
+  bool collapsed = G.getCollapsedLoop(BN);
+
+  DenseMap<const BasicBlock *, unsigned> reachedFrom;
+  SmallPtrSet<const BasicBlock *, 16> reached;
+  SmallPtrSet<const BasicBlock *, 4> successors;
+  unsigned edge = 0;
+  for (succ_const_iterator S = succ_begin(B), SE = succ_end(B); S != SE; ++S) {
+    if (successors.count(*S))
+      continue;
+    successors.insert(*S);
+    ++edge;
+    SmallPtrSet<const BasicBlock *, 16> visited;
+    SmallVector<const BasicBlock *, 16> walk(1, *S);
+    while (!walk.empty()) {
+      const BasicBlock *X = walk.pop_back_val();
+      if (visited.count(X))
+	continue;
+      visited.insert(X);
+      reached.insert(X);
+      if (!inScope(X))
+	continue;
+      std::pair<DenseMap<const BasicBlock *, unsigned>::iterator, bool> R =
+	reachedFrom.insert(std::make_pair(X, edge));
+      if (!R.second && R.first->second != edge)
+	joinAt(X);
+      if (X == B)
+	continue;
+      const ControlDependenceNode *XN = G.getNode(X);
+      if (XN && (controlled.test(XN->getID()) || (collapsed && XN == BN)))
+	walk.append(succ_begin(X), succ_end(X));
+    }
+  }
+
+  // Threads meet again within the iteration of a loop of B unless the walk
+  // leaves the loop or comes back to its header. Otherwise they go on to
+  // leave the loop after different numbers of iterations, even through
+  // uniform exits further down.
+  if (!LI)
+    return;
+  for (const Loop *L = LI->getLoopFor(B); L && L != scope; L = L->getParentLoop())
+    for (SmallPtrSet<const BasicBlock *, 16>::iterator X = reached.begin(), XE = reached.end();
+	 X != XE; ++X)
+      if (!L->contains(*X) || *X == L->getHeader()) {
+	loopExitDiverges(L);
+	break;
+      }
+}
+
+void DivergenceAnalysis::joinAt(const BasicBlock *X) {
+  if (joinPoints.count(X))
+    return;
+  joinPoints.insert(X);
+  for (BasicBlock::const_iterator I = X->begin(); isa<PHINode>(I); ++I)
+    push(I);
+}
+
+// Threads from different iterations meet at every exit of L, whichever exit
+// each of them took, and every value they carry out of L diverges.
+void DivergenceAnalysis::loopExitDiverges(const Loop *L) {
+  if (divergentExits.count(L))
+    return;
+  divergentExits.insert(L);
+  SmallVector<BasicBlock *, 4> exits;
+  L->getExitBlocks(exits);
+  for (unsigned i = 0, e = exits.size(); i != e; ++i)
+    if (inScope(exits[i]))
+      joinAt(exits[i]);
+  for (Loop::block_iterator BB = L->block_begin(), BE = L->block_end(); BB != BE; ++BB)
+    for (BasicBlock::const_iterator I = (*BB)->begin(), IE = (*BB)->end(); I != IE; ++I)
+      for (Value::const_user_iterator U = I->user_begin(), UE = I->user_end(); U != UE; ++U)
+	if (const Instruction *User = dyn_cast<Instruction>(*U))
+	  if (!L->contains(User->getParent()))
+	    push(User);
+}
+
+void DivergenceAnalysis::clear() {
+  scope = NULL;
+  divergent.clear();
+  divergentBranches.clear();
+  joinPoints.clear();
+  divergentExits.clear();
+  worklist.clear();
+}
+
+} // namespace llvm
+
+namespace {
+
+// Prints the divergent values, branches and join points of each function,
+// seeded with the calls to the -divergent-source functions.
+struct DivergencePrinter : public FunctionPass {
+  static char ID;
+  DivergencePrinter() : FunctionPass(ID), function(NULL), DA(NULL) {}
+
+  virtual bool runOnFunction(Function &F) {
+    releaseMemory();
+    function = &F;
+    DA = new DivergenceAnalysis(getAnalysis<ControlDependenceGraph>(), &getAnalysis<LoopInfo>());
+    for (Function::iterator BB = F.begin(), E = F.end(); BB != E; ++BB)
+      for (BasicBlock::iterator I = BB->begin(), IE = BB->end(); I != IE; ++I)
+	if (isSource(I))
+	  DA->markDivergent(I);
+    return false;
+  }
+
+  virtual void releaseMemory() {
+    delete DA;
+    DA = NULL;
+  }
+
+  virtual void print(raw_ostream &OS, const Module *M) const {
+    if (!DA)
+      return;
+    OS << "Divergence of '" << function->getName() << "':\n  values:";
+    for (Function::const_arg_iterator A = function->arg_begin(), AE = function->arg_end();
+	 A != AE; ++A)
+      printIf(OS, A, DA->isDivergent(A));
+    for (Function::const_iterator BB = function->begin(), E = function->end(); BB != E; ++BB)
+      for (BasicBlock::const_iterator I = BB->begin(), IE = BB->end(); I != IE; ++I)
+	printIf(OS, I, !I->getType()->isVoidTy() && DA->isDivergent(I));
+    OS << "\n  branches:";
+    for (Function::const_iterator BB = function->begin(), E = function->end(); BB != E; ++BB)
+      printIf(OS, BB, DA->isDivergentBranch(BB));
+    OS << "\n  join points:";
+    for (Function::const_iterator BB = function->begin(), E = function->end(); BB != E; ++BB)
+      printIf(OS, BB, DA->isJoinPoint(BB));
+    OS << '\n';
+  }
+
+  virtual void getAnalysisUsage(AnalysisUsage &AU) const {
+    AU.setPreservesAll();
+    AU.addRequired<ControlDependenceGraph>();
+    AU.addRequired<LoopInfo>();
+  }
+
+private:
+  const Function *function;
+  DivergenceAnalysis *DA;
+
+  static bool isSource(const Instruction *I) {
+    const CallInst *CI = dyn_cast<CallInst>(I);
+    const Function *Callee = CI ? CI->getCalledFunction() : NULL;
+    if (!Callee)
+      return false;
+    if (DivergentSources.empty())
+      return Callee->getName() == "get_local_id" || Callee->getName() == "get_global_id";
+    for (unsigned i = 0, e = DivergentSources.size(); i != e; ++i)
+      if (Callee->getName() == DivergentSources[i])
+	return true;
+    return false;
+  }
+
+  static void printIf(raw_ostream &OS, const Value *V, bool Cond) {
+    if (!Cond)
+      return;
+    OS << ' ';
+    V->printAsOperand(OS, false);
+  }
+};
+
+} // end anonymous namespace
+
+char DivergencePrinter::ID = 0;
+static RegisterPass<DivergencePrinter> Printer("control-deps-divergence",
+					       "Print the divergent values, branches and join points",
+					       true, true);
@@ -0,0 +1,85 @@
+//===- IntraProc/MachineControlDependenceGraph.cpp --------------*- C++ -*-===//
+//
+//                      Static Program Analysis for LLVM
+//
+// This file is distributed under a Modified BSD License (see LICENSE.TXT).
+//
+//===----------------------------------------------------------------------===//
+//
+// This file defines the MachineControlDependenceGraph pass, the control
+// dependence graph of a MachineFunction.
+//
+//===----------------------------------------------------------------------===//
+
+#include "IntraProc/MachineControlDependenceGraph.h"
+
+#include "llvm/ADT/SmallVector.h"
+#include "llvm/CodeGen/MachineBasicBlock.h"
+#include "llvm/CodeGen/MachinePostDominators.h"
+#include "llvm/Support/raw_ostream.h"
+#include "llvm/Target/TargetInstrInfo.h"
+#include "llvm/Target/TargetMachine.h"
+
+using namespace llvm;
+
+namespace llvm {
+
+// A branch the target can analyze goes to TBB when its condition holds, and
+// otherwise to FBB or, if there is none, to the block laid out after it.
+ControlDependenceEdge::EdgeType
+MachineBranchLabels::getEdgeType(MachineBasicBlock *A, MachineBasicBlock *B) const {
+  MachineBasicBlock *TBB = NULL, *FBB = NULL;
+  SmallVector<MachineOperand, 4> Cond;
+  if (!TII || TII->AnalyzeBranch(*A, TBB, FBB, Cond, false) || Cond.empty())
+    return ControlDependenceEdge::OTHER;
+  if (B == TBB)
+    return ControlDependenceEdge::TRUE;
+  if (B == FBB || (!FBB && A->isLayoutSuccessor(B)))
+    return ControlDependenceEdge::FALSE;
+  return ControlDependenceEdge::OTHER;
+}
+
+void MachineControlDependenceGraph::graphForFunction(MachineFunction &MF,
+                                                     MachinePostDominatorTree &pdt) {
+  recalculate(&MF, pdt, MachineBranchLabels(MF.getTarget().getInstrInfo()));
+}
+
+void MachineControlDependenceGraph::print(raw_ostream &OS, const Module *M) const {
+  for (iterator N = begin(), E = end(); N != E; ++N) {
+    MachineControlDependenceNode *node = *N;
+    OS << "  " << node->getID() << " ";
+    if (node->isRegion())
+      OS << "REGION";
+    else
+      OS << "BB#" << node->getBlock()->getNumber();
+    OS << ":";
+    for (MachineControlDependenceNode::edge_iterator C = node->begin(), CE = node->end();
+	 C != CE; ++C) {
+      switch (C.type()) {
+      case ControlDependenceEdge::TRUE:  OS << " T"; break;
+      case ControlDependenceEdge::FALSE: OS << " F"; break;
+      case ControlDependenceEdge::OTHER: OS << " "; break;
+      }
+      OS << (*C)->getID();
+    }
+    OS << "\n";
+  }
+}
+
+void MachineControlDependenceGraph::getAnalysisUsage(AnalysisUsage &AU) const {
+  AU.addRequired<MachinePostDominatorTree>();
+  AU.setPreservesAll();
+  MachineFunctionPass::getAnalysisUsage(AU);
+}
+
+bool MachineControlDependenceGraph::runOnMachineFunction(MachineFunction &MF) {
+  graphForFunction(MF, getAnalysis<MachinePostDominatorTree>());
+  return false;
+}
+
+} // namespace llvm
+
+char MachineControlDependenceGraph::ID = 0;
+static RegisterPass<MachineControlDependenceGraph> MachineGraph("machine-control-deps",
+								"Compute machine control dependency graphs",
+								true, true);
@@ -0,0 +1,225 @@
+//===- IntraProc/MemoryDependences.cpp --------------------------*- C++ -*-===//
+//
+//                      Static Program Analysis for LLVM
+//
+// This file is distributed under a Modified BSD License (see LICENSE.TXT).
+//
+//===----------------------------------------------------------------------===//
+//
+// This file defines the MemoryDependences class, which attaches memory data
+// dependence edges to a control dependence graph for slicing through loads,
+// stores and calls. The edges come from MemoryDependenceAnalysis, which walks
+// back from each access to the accesses that clobber or define what it reads
+// or writes, and are computed a control dependence region at a time: a query
+// fills in the accesses of every block in the same region as its own, the
+// blocks that run exactly when it does, since slices and impact analyses
+// tend to ask about neighbouring accesses next. Regions nested in it are
+// left until they are asked about.
+//
+//===----------------------------------------------------------------------===//
+
+#include "IntraProc/MemoryDependences.h"
+
+#include "llvm/ADT/SmallVector.h"
+#include "llvm/Analysis/AliasAnalysis.h"
+#include "llvm/Analysis/MemoryDependenceAnalysis.h"
+#include "llvm/IR/CallSite.h"
+#include "llvm/IR/Function.h"
+#include "llvm/IR/Instructions.h"
+#include "llvm/Support/raw_ostream.h"
+
+#include <algorithm>
+
+using namespace llvm;
+
+namespace {
+
+// Orders instructions of one function by program order, given the order of
+// their blocks.
+struct ProgramOrder {
+  const DenseMap<const BasicBlock *, unsigned> &blockOrder;
+
+  explicit ProgramOrder(const DenseMap<const BasicBlock *, unsigned> &blockOrder)
+    : blockOrder(blockOrder) {}
+
+  bool operator()(const Instruction *A, const Instruction *B) const {
+    const BasicBlock *BB = A->getParent();
+    if (BB != B->getParent())
+      return blockOrder.lookup(BB) < blockOrder.lookup(B->getParent());
+    if (A == B)
+      return false;
+    for (BasicBlock::const_iterator I = A, E = BB->end(); I != E; ++I)
+      if (&*I == B)
+	return true;
+    return false;
+  }
+};
+
+} // end anonymous namespace
+
+namespace llvm {
+
+// Record the instruction of a def or clobber; a result that names none, other
+// than the function entry, leaves I's dependences unknown.
+static bool addResult(MemDepResult R, std::vector<Instruction *> &deps) {
+  if (R.isDef() || R.isClobber()) {
+    if (std::find(deps.begin(), deps.end(), R.getInst()) == deps.end())
+      deps.push_back(R.getInst());
+    return true;
+  }
+  return R.isNonFuncLocal();
+}
+
+void MemoryDependences::computeFor(Instruction *I) {
+  std::vector<Instruction *> &deps = dependences[I];
+  MemDepResult R = MDA.getDependency(I);
+  if (!R.isNonLocal()) {
+    if (!addResult(R, deps))
+      unknown.insert(I);
+    return;
+  }
+
+  // The nearest accesses lie in predecessors; MemoryDependenceAnalysis keeps
+  // what it walks through, so queries from the same region share their work.
+  bool known = true;
+  CallSite CS(I);
+  if (CS) {
+    const MemoryDependenceAnalysis::NonLocalDepInfo &D = MDA.getNonLocalCallDependency(CS);
+    for (unsigned i = 0, e = D.size(); i != e; ++i)
+      known &= addResult(D[i].getResult(), deps);
+  } else if (isa<LoadInst>(I) || isa<StoreInst>(I)) {
+    AliasAnalysis::Location Loc = isa<LoadInst>(I) ? AA.getLocation(cast<LoadInst>(I))
+					           : AA.getLocation(cast<StoreInst>(I));
+    SmallVector<NonLocalDepResult, 8> D;
+    MDA.getNonLocalPointerDependency(Loc, isa<LoadInst>(I), I->getParent(), D);
+    for (unsigned i = 0, e = D.size(); i != e; ++i)
+      known &= addResult(D[i].getResult(), deps);
+  } else {
+    known = false;
+  }
+  if (!known)
+    unknown.insert(I);
+
+  // The results come in the order MemoryDependenceAnalysis keeps its blocks,
+  // which depends on where they happen to be allocated.
+  if (blockOrder.empty()) {
+    const Function *F = I->getParent()->getParent();
+    unsigned n = 0;
+    for (Function::const_iterator BB = F->begin(), E = F->end(); BB != E; ++BB)
+      blockOrder[BB] = n++;
+  }
+  std::sort(deps.begin(), deps.end(), ProgramOrder(blockOrder));
+}
+
+void MemoryDependences::computeBlock(BasicBlock *BB) {
+  if (computedBlocks.count(BB))
+    return;
+  computedBlocks.insert(BB);
+  for (BasicBlock::iterator I = BB->begin(), E = BB->end(); I != E; ++I)
+    if (I->mayReadOrWriteMemory())
+      computeFor(I);
+}
+
+// The blocks of a region run together, so their accesses are computed
+// together. Those are the block children of the region's node; the regions
+// among its children are nested in it and wait for their own queries. The
+// other blocks of a collapsed loop share the node of its header and are
+// computed one at a time as they are asked about.
+void MemoryDependences::computeRegion(BasicBlock *BB) {
+  computeBlock(BB);
+  // A block the graph leaves out has no region and is computed alone. The
+  // region of the entry block is the root, node 0, whose blocks are those
+  // that run whenever the function does.
+  const ControlDependenceNode *R = G.enclosingRegion(BB);
+  if (!R)
+    return;
+  ControlDependenceNode *RN = const_cast<ControlDependenceNode *>(R);
+  for (ControlDependenceNode::edge_iterator C = RN->begin(), E = RN->end(); C != E; ++C)
+    if (!(*C)->isRegion())
+      computeBlock((*C)->getBlock());
+}
+
+ArrayRef<Instruction *> MemoryDependences::getDependences(Instruction *I) {
+  computeRegion(I->getParent());
+  DenseMap<const Instruction *, std::vector<Instruction *> >::const_iterator D =
+    dependences.find(I);
+  if (D == dependences.end())
+    return ArrayRef<Instruction *>();
+  return D->second;
+}
+
+bool MemoryDependences::hasUnknownDependences(Instruction *I) {
+  computeRegion(I->getParent());
+  return unknown.count(I);
+}
+
+void MemoryDependences::clear() {
+  dependences.clear();
+  unknown.clear();
+  computedBlocks.clear();
+  blockOrder.clear();
+}
+
+void MemoryDependences::print(raw_ostream &OS, const Function &F) {
+  OS << "Memory dependences for '" << F.getName() << "':\n";
+  for (Function::const_iterator BB = F.begin(), E = F.end(); BB != E; ++BB)
+    for (BasicBlock::const_iterator I = BB->begin(), IE = BB->end(); I != IE; ++I) {
+      if (!I->mayReadOrWriteMemory())
+	continue;
+      Instruction *Inst = const_cast<Instruction *>(&*I);
+      ArrayRef<Instruction *> deps = getDependences(Inst);
+      OS << " " << *I << "\n";
+      for (unsigned i = 0, e = deps.size(); i != e; ++i)
+	OS << "      <- " << *deps[i] << "\n";
+      if (hasUnknownDependences(Inst))
+	OS << "      <- unknown\n";
+    }
+}
+
+} // namespace llvm
+
+namespace {
+
+// Prints the memory dependences of every access of a function, computed a
+// region at a time as the printer reaches each access.
+struct MemoryDependencesPrinter : public FunctionPass {
+  static char ID;
+  MemoryDependencesPrinter() : FunctionPass(ID), function(NULL), deps(NULL) {}
+
+  virtual bool runOnFunction(Function &F) {
+    releaseMemory();
+    function = &F;
+    deps = new MemoryDependences(getAnalysis<ControlDependenceGraph>(),
+				 getAnalysis<MemoryDependenceAnalysis>(),
+				 getAnalysis<AliasAnalysis>());
+    return false;
+  }
+
+  virtual void releaseMemory() {
+    delete deps;
+    deps = NULL;
+  }
+
+  virtual void print(raw_ostream &OS, const Module *M) const {
+    if (deps)
+      deps->print(OS, *function);
+  }
+
+  virtual void getAnalysisUsage(AnalysisUsage &AU) const {
+    AU.setPreservesAll();
+    AU.addRequired<ControlDependenceGraph>();
+    AU.addRequired<MemoryDependenceAnalysis>();
+    AU.addRequired<AliasAnalysis>();
+  }
+
+private:
+  const Function *function;
+  MemoryDependences *deps;
+};
+
+} // end anonymous namespace
+
+char MemoryDependencesPrinter::ID = 0;
+static RegisterPass<MemoryDependencesPrinter> Printer("memory-deps",
+						      "Print the memory dependences of every access",
+						      true, true);
@@ -0,0 +1,132 @@
+//===- IntraProc/MustExecuteSummaries.cpp -----------------------*- C++ -*-===//
+//
+//                      Static Program Analysis for LLVM
+//
+// This file is distributed under a Modified BSD License (see LICENSE.TXT).
+//
+//===----------------------------------------------------------------------===//
+//
+// This file defines the MustExecuteSummaries pass. It records the blocks of
+// every function that execute whenever the function is entered, the blocks of
+// the root region of its control dependence graph, and propagates them
+// bottom-up over the call graph to find the functions each function always
+// calls. Calls are assumed to return.
+//
+//===----------------------------------------------------------------------===//
+
+#include "IntraProc/MustExecuteSummaries.h"
+#include "IntraProc/ControlDependenceGraph.h"
+#include "IntraProc/ControlDependenceRegions.h"
+
+#include "llvm/ADT/SCCIterator.h"
+#include "llvm/Analysis/CallGraph.h"
+#include "llvm/IR/CallSite.h"
+#include "llvm/IR/Function.h"
+#include "llvm/IR/Instruction.h"
+#include "llvm/Support/raw_ostream.h"
+
+#include <vector>
+
+using namespace llvm;
+
+namespace llvm {
+
+bool MustExecuteSummaries::runOnModule(Module &M) {
+  ControlDependenceGraphs &CDGs = getAnalysis<ControlDependenceGraphs>();
+  CallGraph &CG = getAnalysis<CallGraphWrapperPass>().getCallGraph();
+
+  // Callees are summarized before their callers, so a function always calls
+  // what the functions it calls from its root region always call. Within a
+  // strongly connected component that is iterated to a fixed point.
+  for (scc_iterator<CallGraph *> I = scc_begin(&CG); !I.isAtEnd(); ++I) {
+    const std::vector<CallGraphNode *> &SCC = *I;
+    std::vector<const Function *> members;
+    for (unsigned i = 0, e = SCC.size(); i != e; ++i) {
+      const Function *F = SCC[i]->getFunction();
+      if (!F || F->isDeclaration())
+	continue;
+      members.push_back(F);
+      const ControlDependenceRegions &R = CDGs.regionsFor(F);
+      FunctionSet &called = callees[F];
+      for (Function::const_iterator BB = F->begin(), E = F->end(); BB != E; ++BB) {
+	if (!R.alwaysExecutes(BB))
+	  continue;
+	executed.insert(BB);
+	for (BasicBlock::const_iterator Inst = BB->begin(), IE = BB->end(); Inst != IE; ++Inst) {
+	  ImmutableCallSite CS(Inst);
+	  if (!CS)
+	    continue;
+	  const Function *G = CS.getCalledFunction();
+	  if (G && !G->isIntrinsic())
+	    called.insert(G);
+	}
+      }
+    }
+
+    bool changed = true;
+    while (changed) {
+      changed = false;
+      for (unsigned i = 0, e = members.size(); i != e; ++i) {
+	FunctionSet &called = callees.find(members[i])->second;
+	std::vector<const Function *> direct(called.begin(), called.end());
+	for (unsigned j = 0, je = direct.size(); j != je; ++j) {
+	  DenseMap<const Function *, FunctionSet>::const_iterator G = callees.find(direct[j]);
+	  if (G == callees.end() || &G->second == &called)
+	    continue;
+	  for (FunctionSet::const_iterator H = G->second.begin(), HE = G->second.end(); H != HE; ++H)
+	    changed |= called.insert(*H).second;
+	}
+      }
+    }
+  }
+  return false;
+}
+
+bool MustExecuteSummaries::alwaysCalls(const Function *F, const Function *G) const {
+  DenseMap<const Function *, FunctionSet>::const_iterator C = callees.find(F);
+  return C != callees.end() && C->second.count(G);
+}
+
+bool MustExecuteSummaries::alwaysReaches(const Function *F, const Instruction *I) const {
+  const BasicBlock *BB = I->getParent();
+  const Function *P = BB->getParent();
+  return alwaysExecutes(BB) && (P == F || alwaysCalls(F, P));
+}
+
+void MustExecuteSummaries::releaseMemory() {
+  executed.clear();
+  callees.clear();
+}
+
+void MustExecuteSummaries::print(raw_ostream &OS, const Module *M) const {
+  if (!M)
+    return;
+  for (Module::const_iterator F = M->begin(), E = M->end(); F != E; ++F) {
+    if (F->isDeclaration())
+      continue;
+    OS << "Must-execute summary for '" << F->getName() << "':\n  blocks:";
+    for (Function::const_iterator BB = F->begin(), BE = F->end(); BB != BE; ++BB)
+      if (alwaysExecutes(BB)) {
+	OS << ' ';
+	BB->printAsOperand(OS, false);
+      }
+    OS << "\n  calls:";
+    for (Module::const_iterator G = M->begin(); G != E; ++G)
+      if (alwaysCalls(F, G))
+	OS << ' ' << G->getName();
+    OS << '\n';
+  }
+}
+
+void MustExecuteSummaries::getAnalysisUsage(AnalysisUsage &AU) const {
+  AU.addRequired<ControlDependenceGraphs>();
+  AU.addRequired<CallGraphWrapperPass>();
+  AU.setPreservesAll();
+}
+
+} // namespace llvm
+
+char MustExecuteSummaries::ID = 0;
+static RegisterPass<MustExecuteSummaries> Summaries("must-execute",
+						    "Summarize the blocks and callees every call executes",
+						    true, true);
@@ -0,0 +1,257 @@
+//===- IntraProc/PathConditions.cpp -----------------------------*- C++ -*-===//
+//
+//                      Static Program Analysis for LLVM
+//
+// This file is distributed under a Modified BSD License (see LICENSE.TXT).
+//
+//===----------------------------------------------------------------------===//
+//
+// This file defines the PathConditions class, which gives every block the
+// predicate under which it executes, built from the controllers of the
+// regions of a control dependence graph. Conditions are hash-consed into a
+// DAG: structurally equal formulas are the same object, blocks of the same
+// region share one, and each region's formula is built on those of the
+// regions controlling it, so clients can memoize on condition pointers.
+//
+//===----------------------------------------------------------------------===//
+
+#include "IntraProc/PathConditions.h"
+
+#include "llvm/ADT/SmallVector.h"
+#include "llvm/IR/BasicBlock.h"
+#include "llvm/IR/Function.h"
+#include "llvm/Pass.h"
+#include "llvm/Support/raw_ostream.h"
+
+#include <algorithm>
+
+using namespace llvm;
+
+namespace llvm {
+
+static void profile(FoldingSetNodeID &FID, PathCondition::Kind K, const BasicBlock *Branch,
+                    ControlDependenceNode::EdgeType Type,
+                    ControlDependenceRegions::RegionID Target,
+                    ArrayRef<const PathCondition *> Ops) {
+  FID.AddInteger(unsigned(K));
+  FID.AddPointer(Branch);
+  FID.AddInteger(unsigned(Type));
+  FID.AddInteger(Target);
+  for (unsigned i = 0, e = Ops.size(); i != e; ++i)
+    FID.AddPointer(Ops[i]);
+}
+
+void PathCondition::Profile(FoldingSetNodeID &FID) const {
+  profile(FID, kind, branch, type, target, makeArrayRef(ops, numOps));
+}
+
+void PathCondition::print(raw_ostream &OS) const {
+  OS << 'c' << ID << " = ";
+  switch (kind) {
+  case True:
+    OS << "true";
+    break;
+  case Literal:
+    if (branch->hasName())
+      OS << branch->getName();
+    else
+      OS << "<unnamed>";
+    switch (type) {
+    case ControlDependenceNode::TRUE:  OS << ".T"; break;
+    case ControlDependenceNode::FALSE: OS << ".F"; break;
+    case ControlDependenceNode::OTHER: OS << "->R" << target; break;
+    }
+    break;
+  case And:
+  case Or:
+    for (unsigned i = 0; i != numOps; ++i)
+      OS << (i == 0 ? "" : kind == And ? " & " : " | ") << 'c' << ops[i]->getID();
+    break;
+  }
+}
+
+// Orders conditions by ID, so that operand lists do not depend on where the
+// conditions happen to be allocated.
+static bool lessID(const PathCondition *A, const PathCondition *B) {
+  return A->getID() < B->getID();
+}
+
+PathConditions::PathConditions(const ControlDependenceRegions &R) : regions(R) {
+  trueCond = unique(PathCondition::True, NULL, ControlDependenceNode::OTHER, 0,
+		    ArrayRef<const PathCondition *>());
+  unsigned n = R.getNumRegions();
+  conditions.assign(n, NULL);
+  if (n == 0)
+    return;
+
+  // Walk the region tree breadth-first from the root, so a region's parent,
+  // one of its controllers, always has its condition already.
+  std::vector<unsigned> childBegin(n + 1, 0), children(n ? n - 1 : 0);
+  for (unsigned r = 0; r != n; ++r)
+    if (r != R.getRootRegion())
+      ++childBegin[R.getParentRegion(r) + 1];
+  for (unsigned r = 0; r != n; ++r)
+    childBegin[r+1] += childBegin[r];
+  std::vector<unsigned> fill(childBegin.begin(), childBegin.end() - 1);
+  for (unsigned r = 0; r != n; ++r)
+    if (r != R.getRootRegion())
+      children[fill[R.getParentRegion(r)]++] = r;
+
+  std::vector<unsigned> queue(1, R.getRootRegion());
+  conditions[R.getRootRegion()] = trueCond;
+  for (unsigned head = 0; head != queue.size(); ++head) {
+    unsigned r = queue[head];
+    if (r != R.getRootRegion()) {
+      SmallVector<const PathCondition *, 4> terms;
+      for (ControlDependenceRegions::controller_iterator C = R.controller_begin(r),
+	     CE = R.controller_end(r); C != CE; ++C) {
+	// The function entry reaches the region unconditionally.
+	if (!C->Branch) {
+	  terms.push_back(trueCond);
+	  continue;
+	}
+	// A controller in a region later in breadth-first order, such as a
+	// loop latch or a branch nested deeper than r, has no condition yet;
+	// its literal alone stands in for the path to it.
+	const PathCondition *lit = getLiteral(C->Branch, C->Type, r);
+	const PathCondition *above = conditions[R.controllingRegion(*C)];
+	terms.push_back(above ? getAnd(above, lit) : lit);
+      }
+      conditions[r] = terms.empty() ? trueCond : getOr(terms);
+    }
+    for (unsigned i = childBegin[r]; i != childBegin[r+1]; ++i)
+      queue.push_back(children[i]);
+  }
+}
+
+const PathCondition *PathConditions::unique(PathCondition::Kind K, const BasicBlock *Branch,
+                                            ControlDependenceNode::EdgeType Type,
+                                            ControlDependenceRegions::RegionID Target,
+                                            ArrayRef<const PathCondition *> Ops) {
+  FoldingSetNodeID FID;
+  profile(FID, K, Branch, Type, Target, Ops);
+  void *InsertPos = NULL;
+  if (PathCondition *C = uniquer.FindNodeOrInsertPos(FID, InsertPos))
+    return C;
+
+  PathCondition *C = new (allocator.Allocate<PathCondition>()) PathCondition(K, all.size());
+  C->branch = Branch;
+  C->type = Type;
+  C->target = Target;
+  C->numOps = Ops.size();
+  if (!Ops.empty()) {
+    C->ops = allocator.Allocate<const PathCondition *>(Ops.size());
+    std::copy(Ops.begin(), Ops.end(), C->ops);
+  }
+  uniquer.InsertNode(C, InsertPos);
+  all.push_back(C);
+  return C;
+}
+
+const PathCondition *PathConditions::getLiteral(const BasicBlock *Branch,
+                                                ControlDependenceNode::EdgeType Type,
+                                                ControlDependenceRegions::RegionID Target) {
+  if (Type != ControlDependenceNode::OTHER)
+    Target = 0;
+  return unique(PathCondition::Literal, Branch, Type, Target,
+		ArrayRef<const PathCondition *>());
+}
+
+const PathCondition *PathConditions::getAnd(const PathCondition *A, const PathCondition *B) {
+  if (A->getKind() == PathCondition::True || A == B)
+    return B;
+  if (B->getKind() == PathCondition::True)
+    return A;
+  const PathCondition *Ops[2] = { A, B };
+  if (lessID(B, A))
+    std::swap(Ops[0], Ops[1]);
+  return unique(PathCondition::And, NULL, ControlDependenceNode::OTHER, 0, Ops);
+}
+
+const PathCondition *PathConditions::getOr(ArrayRef<const PathCondition *> Ops) {
+  assert(!Ops.empty() && "Empty disjunction!");
+  SmallVector<const PathCondition *, 8> flat;
+  for (unsigned i = 0, e = Ops.size(); i != e; ++i) {
+    if (Ops[i]->getKind() == PathCondition::True)
+      return Ops[i];
+    if (Ops[i]->getKind() == PathCondition::Or)
+      flat.append(Ops[i]->op_begin(), Ops[i]->op_end());
+    else
+      flat.push_back(Ops[i]);
+  }
+  std::sort(flat.begin(), flat.end(), lessID);
+  flat.erase(std::unique(flat.begin(), flat.end()), flat.end());
+  if (flat.size() == 1)
+    return flat[0];
+  return unique(PathCondition::Or, NULL, ControlDependenceNode::OTHER, 0, flat);
+}
+
+const PathCondition *PathConditions::getCondition(const BasicBlock *BB) const {
+  ControlDependenceRegions::RegionID R = regions.enclosingRegion(BB);
+  return R == ControlDependenceRegions::NoRegion ? NULL : conditions[R];
+}
+
+void PathConditions::print(raw_ostream &OS) const {
+  for (unsigned i = 0, e = all.size(); i != e; ++i) {
+    OS << "  ";
+    all[i]->print(OS);
+    OS << "\n";
+  }
+  for (unsigned r = 0, e = conditions.size(); r != e; ++r)
+    OS << "  region " << r << ": c" << conditions[r]->getID() << "\n";
+}
+
+} // namespace llvm
+
+namespace {
+
+// Prints the path conditions of each function, then the condition of each
+// block.
+struct PathConditionsPrinter : public FunctionPass {
+  static char ID;
+  PathConditionsPrinter() : FunctionPass(ID), function(NULL), PC(NULL) {}
+
+  virtual bool runOnFunction(Function &F) {
+    releaseMemory();
+    function = &F;
+    R.summarize(F, getAnalysis<ControlDependenceGraph>());
+    PC = new PathConditions(R);
+    return false;
+  }
+
+  virtual void releaseMemory() {
+    delete PC;
+    PC = NULL;
+    R.clear();
+  }
+
+  virtual void print(raw_ostream &OS, const Module *M) const {
+    if (!PC)
+      return;
+    OS << "Path conditions for '" << function->getName() << "':\n";
+    PC->print(OS);
+    for (Function::const_iterator BB = function->begin(), E = function->end(); BB != E; ++BB)
+      if (const PathCondition *C = PC->getCondition(BB)) {
+	OS << "  ";
+	BB->printAsOperand(OS, false);
+	OS << ": c" << C->getID() << "\n";
+      }
+  }
+
+  virtual void getAnalysisUsage(AnalysisUsage &AU) const {
+    AU.setPreservesAll();
+    AU.addRequired<ControlDependenceGraph>();
+  }
+
+private:
+  const Function *function;
+  ControlDependenceRegions R;
+  PathConditions *PC;
+};
+
+} // end anonymous namespace
+
+char PathConditionsPrinter::ID = 0;
+static RegisterPass<PathConditionsPrinter> Printer("path-conditions",
+						   "Print the path condition of every block",
+						   true, true);
@@ -0,0 +1,150 @@
+//===- IntraProc/PostDominatorBuilder.cpp -----------------------*- C++ -*-===//
+//
+//                      Static Program Analysis for LLVM
+//
+// This file is distributed under a Modified BSD License (see LICENSE.TXT).
+//
+//===----------------------------------------------------------------------===//
+//
+// This file defines the PostDominatorBuilder class, which computes immediate
+// post-dominators with the Semi-NCA algorithm of Georgiadis et al. It works on
+// a CFG given as flat successor arrays so that control dependence
+// construction can run without a PostDominatorTree from the pass manager.
+//
+//===----------------------------------------------------------------------===//
+
+#include "IntraProc/PostDominatorBuilder.h"
+
+using namespace llvm;
+
+namespace llvm {
+
+// Number the reverse CFG in depth-first preorder starting from Root, whose
+// tree parent has DFS number ParentNum. The successors of a block in the
+// reverse CFG are its predecessors; those of the virtual exit are the blocks
+// without successors and those with an explicit edge to it. The walk keeps
+// its own stack, so deep CFGs cannot overflow the call stack.
+void PostDominatorBuilder::runDFS(unsigned Root, unsigned ParentNum, unsigned Exit,
+                                  ArrayRef<unsigned> SuccBegin) {
+  WorkNode.push_back(Root);
+  WorkParent.push_back(ParentNum);
+  while (!WorkNode.empty()) {
+    unsigned V = WorkNode.back();
+    unsigned P = WorkParent.back();
+    WorkNode.pop_back();
+    WorkParent.pop_back();
+    if (Num[V])
+      continue;
+
+    Num[V] = ++LastNum;
+    Vertex[LastNum] = V;
+    Parent[V] = P;
+    Semi[V] = LastNum;
+    Label[V] = V;
+
+    if (V == Exit) {
+      for (unsigned B = Exit; B-- != 0; ) {
+        if (SuccBegin[B] == SuccBegin[B+1]) {
+          WorkNode.push_back(B);
+          WorkParent.push_back(LastNum);
+        }
+      }
+    }
+    for (unsigned I = PredBegin[V+1]; I-- != PredBegin[V]; ) {
+      if (!Num[Preds[I]]) {
+        WorkNode.push_back(Preds[I]);
+        WorkParent.push_back(LastNum);
+      }
+    }
+  }
+}
+
+// Find the vertex with minimal semidominator on the path from V to the root
+// of its tree in the forest of already linked vertices, compressing the path
+// as we go. Vertices numbered LastLinked or higher are linked.
+unsigned PostDominatorBuilder::eval(unsigned V, unsigned LastLinked) {
+  if (Parent[V] < LastLinked)
+    return Label[V];
+
+  EvalStack.clear();
+  do {
+    EvalStack.push_back(V);
+    V = Vertex[Parent[V]];
+  } while (Parent[V] >= LastLinked);
+
+  unsigned P = V;
+  do {
+    V = EvalStack.back();
+    EvalStack.pop_back();
+    Parent[V] = Parent[P];
+    if (Semi[Label[P]] < Semi[Label[V]])
+      Label[V] = Label[P];
+    P = V;
+  } while (!EvalStack.empty());
+  return Label[V];
+}
+
+void PostDominatorBuilder::compute(unsigned NumBlocks,
+                                   ArrayRef<unsigned> SuccBegin,
+                                   ArrayRef<unsigned> Succs,
+                                   SmallVectorImpl<unsigned> &IPDom) {
+  unsigned Exit = NumBlocks;
+  unsigned N = NumBlocks + 1;
+
+  // The reverse CFG, as predecessor arrays.
+  PredBegin.assign(N + 1, 0);
+  for (unsigned I = 0, E = Succs.size(); I != E; ++I)
+    ++PredBegin[Succs[I] + 1];
+  for (unsigned V = 0; V != N; ++V)
+    PredBegin[V+1] += PredBegin[V];
+  Preds.resize(Succs.size());
+  WorkNode.assign(PredBegin.begin(), PredBegin.end() - 1);
+  for (unsigned B = 0; B != NumBlocks; ++B)
+    for (unsigned I = SuccBegin[B], E = SuccBegin[B+1]; I != E; ++I)
+      Preds[WorkNode[Succs[I]]++] = B;
+  WorkNode.clear();
+
+  // Step 1: number the reverse CFG from the virtual exit, then hang every
+  // block that cannot reach an exit off the virtual exit.
+  Num.assign(N, 0);
+  Vertex.assign(N + 1, 0);
+  Parent.assign(N, 0);
+  Semi.assign(N, 0);
+  Label.assign(N, 0);
+  LastNum = 0;
+  runDFS(Exit, 0, Exit, SuccBegin);
+  for (unsigned B = NumBlocks; B-- != 0; )
+    if (!Num[B])
+      runDFS(B, 1, Exit, SuccBegin);
+
+  IPDom.resize(N);
+  IPDom[Exit] = Exit;
+  for (unsigned I = 2; I <= LastNum; ++I)
+    IPDom[Vertex[I]] = Vertex[Parent[Vertex[I]]];
+
+  // Step 2: semidominators, in reverse preorder. The predecessors of a block
+  // in the reverse CFG are its successors; a block hanging off the virtual
+  // exit already has the smallest possible semidominator, its parent.
+  for (unsigned I = LastNum; I >= 2; --I) {
+    unsigned W = Vertex[I];
+    unsigned S = Parent[W];
+    for (unsigned J = SuccBegin[W], E = SuccBegin[W+1]; J != E; ++J) {
+      unsigned U = eval(Succs[J], I + 1);
+      if (Semi[U] < S)
+        S = Semi[U];
+    }
+    Semi[W] = S;
+  }
+
+  // Step 3: the immediate post-dominator of W is the nearest common ancestor
+  // of its semidominator and its tree parent.
+  for (unsigned I = 2; I <= LastNum; ++I) {
+    unsigned W = Vertex[I];
+    unsigned C = IPDom[W];
+    while (Num[C] > Semi[W])
+      C = IPDom[C];
+    IPDom[W] = C;
+  }
+}
+
+} // namespace llvm
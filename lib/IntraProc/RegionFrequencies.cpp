@@ -0,0 +1,217 @@
+//===- IntraProc/RegionFrequencies.cpp --------------------------*- C++ -*-===//
+//
+//                      Static Program Analysis for LLVM
+//
+// This file is distributed under a Modified BSD License (see LICENSE.TXT).
+//
+//===----------------------------------------------------------------------===//
+//
+// This file defines the RegionFrequencies class, a quick estimate of block
+// frequencies for triage. A block runs as often as its region, and a region
+// as often as its controllers take the edges into it, so one pass over the
+// regions in topological order, weighting each controller's frequency by the
+// probability of its edge, estimates them all.
+//
+//===----------------------------------------------------------------------===//
+
+#include "IntraProc/RegionFrequencies.h"
+
+#include "llvm/Analysis/BranchProbabilityInfo.h"
+#include "llvm/IR/Function.h"
+#include "llvm/Pass.h"
+#include "llvm/Support/Format.h"
+#include "llvm/Support/raw_ostream.h"
+
+#include <utility>
+
+using namespace llvm;
+
+namespace llvm {
+
+const unsigned RegionFrequencies::MaxLoopScale;
+
+static double toDouble(BranchProbability P) {
+  return double(P.getNumerator()) / P.getDenominator();
+}
+
+// Return the probability that C's branch takes an edge into Target. The
+// labelled edges of a conditional branch are its first and second successor;
+// an OTHER edge stands for all the successors in Target, or, when none is,
+// as for the exits of a collapsed loop, for an even share of them.
+double RegionFrequencies::edgeProbability(
+    const ControlDependenceRegions::Controller &C,
+    ControlDependenceRegions::RegionID Target,
+    const BranchProbabilityInfo &BPI) const {
+  switch (C.Type) {
+  case ControlDependenceNode::TRUE:
+    return toDouble(BPI.getEdgeProbability(C.Branch, 0U));
+  case ControlDependenceNode::FALSE:
+    return toDouble(BPI.getEdgeProbability(C.Branch, 1U));
+  case ControlDependenceNode::OTHER:
+    break;
+  }
+  const TerminatorInst *TI = C.Branch->getTerminator();
+  unsigned n = TI->getNumSuccessors();
+  if (n == 0)
+    return 0;
+  double p = 0;
+  bool found = false;
+  for (unsigned i = 0; i != n; ++i)
+    if (regions.enclosingRegion(TI->getSuccessor(i)) == Target) {
+      p += toDouble(BPI.getEdgeProbability(C.Branch, i));
+      found = true;
+    }
+  return found ? p : 1.0 / n;
+}
+
+RegionFrequencies::RegionFrequencies(const ControlDependenceRegions &R,
+                                     const BranchProbabilityInfo &BPI)
+  : regions(R) {
+  unsigned n = R.getNumRegions();
+  frequencies.assign(n, 0);
+  if (n == 0)
+    return;
+  typedef ControlDependenceRegions::controller_iterator controller_iterator;
+
+  // Each controller is an edge from the region holding its branch to the
+  // region it controls.
+  std::vector<unsigned> succBegin(n + 1, 0);
+  for (unsigned r = 0; r != n; ++r)
+    for (controller_iterator C = R.controller_begin(r),
+	   CE = R.controller_end(r); C != CE; ++C)
+      if (C->Branch)
+	++succBegin[R.controllingRegion(*C) + 1];
+  for (unsigned r = 0; r != n; ++r)
+    succBegin[r+1] += succBegin[r];
+  std::vector<unsigned> succs(succBegin[n]);
+  std::vector<unsigned> fill(succBegin.begin(), succBegin.end() - 1);
+  for (unsigned r = 0; r != n; ++r)
+    for (controller_iterator C = R.controller_begin(r),
+	   CE = R.controller_end(r); C != CE; ++C)
+      if (C->Branch)
+	succs[fill[R.controllingRegion(*C)]++] = r;
+
+  // Number the regions in reverse post-order of a depth-first search from
+  // the root. An edge that does not lead to a later region is a back edge
+  // to a region still on the search stack; every other edge is forward, so
+  // its source is estimated before its target. Regions the root does not
+  // reach are searched from in turn.
+  std::vector<unsigned> order(n), rpo(n, n);
+  std::vector<bool> visited(n, false);
+  std::vector<std::pair<unsigned, unsigned> > stack;
+  unsigned next = n;
+  for (unsigned i = 0; i <= n; ++i) {
+    unsigned start = i == 0 ? R.getRootRegion() : i - 1;
+    if (visited[start])
+      continue;
+    visited[start] = true;
+    stack.push_back(std::make_pair(start, succBegin[start]));
+    while (!stack.empty()) {
+      unsigned r = stack.back().first;
+      unsigned &e = stack.back().second;
+      if (e == succBegin[r+1]) {
+	rpo[r] = --next;
+	order[next] = r;
+	stack.pop_back();
+	continue;
+      }
+      unsigned s = succs[e++];
+      if (!visited[s]) {
+	visited[s] = true;
+	stack.push_back(std::make_pair(s, succBegin[s]));
+      }
+    }
+  }
+
+  // A region with no controllers, such as every region of an approximate
+  // graph, is taken to run once.
+  for (unsigned i = 0; i != n; ++i) {
+    unsigned r = order[i];
+    double known = 0, back = 0;
+    bool controlled = false;
+    for (controller_iterator C = R.controller_begin(r),
+	   CE = R.controller_end(r); C != CE; ++C) {
+      controlled = true;
+      if (!C->Branch) {
+	known += 1;
+	continue;
+      }
+      double p = edgeProbability(*C, r, BPI);
+      unsigned from = R.controllingRegion(*C);
+      if (rpo[from] < rpo[r])
+	known += frequencies[from] * p;
+      else
+	back += p;
+    }
+    if (r == R.getRootRegion() || !controlled) {
+      frequencies[r] = 1;
+    } else {
+      double scale = back < 1 ? 1 / (1 - back) : MaxLoopScale;
+      frequencies[r] = known * (scale < MaxLoopScale ? scale : MaxLoopScale);
+    }
+  }
+}
+
+double RegionFrequencies::getFrequency(const BasicBlock *BB) const {
+  ControlDependenceRegions::RegionID R = regions.enclosingRegion(BB);
+  return R == ControlDependenceRegions::NoRegion ? 0 : frequencies[R];
+}
+
+void RegionFrequencies::print(raw_ostream &OS, const Function &F) const {
+  OS << "Region frequencies for '" << F.getName() << "':\n";
+  for (Function::const_iterator BB = F.begin(), E = F.end(); BB != E; ++BB) {
+    OS << "  ";
+    if (BB->hasName())
+      OS << BB->getName();
+    else
+      OS << "<unnamed>";
+    OS << ": " << format("%.4g", getFrequency(BB)) << "\n";
+  }
+}
+
+} // namespace llvm
+
+namespace {
+
+// Prints the estimated frequency of every block of each function.
+struct RegionFrequenciesPrinter : public FunctionPass {
+  static char ID;
+  RegionFrequenciesPrinter() : FunctionPass(ID), function(NULL), RF(NULL) {}
+
+  virtual bool runOnFunction(Function &F) {
+    releaseMemory();
+    function = &F;
+    R.summarize(F, getAnalysis<ControlDependenceGraph>());
+    RF = new RegionFrequencies(R, getAnalysis<BranchProbabilityInfo>());
+    return false;
+  }
+
+  virtual void releaseMemory() {
+    delete RF;
+    RF = NULL;
+    R.clear();
+  }
+
+  virtual void print(raw_ostream &OS, const Module *M) const {
+    if (RF)
+      RF->print(OS, *function);
+  }
+
+  virtual void getAnalysisUsage(AnalysisUsage &AU) const {
+    AU.setPreservesAll();
+    AU.addRequired<ControlDependenceGraph>();
+    AU.addRequired<BranchProbabilityInfo>();
+  }
+
+private:
+  const Function *function;
+  ControlDependenceRegions R;
+  RegionFrequencies *RF;
+};
+
+} // end anonymous namespace
+
+char RegionFrequenciesPrinter::ID = 0;
+static RegisterPass<RegionFrequenciesPrinter> Printer("region-frequencies",
+						      "Print the estimated frequency of every block",
+						      true, true);
@@ -0,0 +1,175 @@
+//===- IntraProc/UnswitchCandidates.cpp -------------------------*- C++ -*-===//
+//
+//                      Static Program Analysis for LLVM
+//
+// This file is distributed under a Modified BSD License (see LICENSE.TXT).
+//
+//===----------------------------------------------------------------------===//
+//
+// This file defines the UnswitchCandidates pass, which lists for every loop
+// the conditional branches on loop-invariant conditions that are worth
+// unswitching. Unswitching a branch duplicates its loop, and each copy drops
+// the blocks that only the side of the branch it does not take controls; the
+// control dependence graph gives those blocks directly.
+//
+//===----------------------------------------------------------------------===//
+
+#include "IntraProc/UnswitchCandidates.h"
+#include "IntraProc/ControlDependenceGraph.h"
+
+#include "llvm/ADT/BitVector.h"
+#include "llvm/Analysis/LoopInfo.h"
+#include "llvm/IR/Instructions.h"
+#include "llvm/Support/CommandLine.h"
+#include "llvm/Support/raw_ostream.h"
+
+#include <algorithm>
+
+using namespace llvm;
+
+static cl::opt<unsigned>
+Threshold("unswitch-candidate-threshold", cl::init(100),
+          cl::desc("Report branches whose unswitching grows the loop by at "
+                   "most this many instructions"));
+
+namespace {
+
+struct MoreBeneficial {
+  bool operator()(const UnswitchCandidates::Candidate &A,
+                  const UnswitchCandidates::Candidate &B) const {
+    return A.Benefit > B.Benefit;
+  }
+};
+
+} // end anonymous namespace
+
+// Mark in Seen the nodes below the children of N along edges of type T.
+// Inside a loop the graph has cycles through the latches, so the walk stops
+// at N and at the loop header H: what lies past them is the next iteration,
+// which both copies of the loop run. H itself is still marked.
+static void markSide(const ControlDependenceNode *N, const ControlDependenceNode *H,
+		     ControlDependenceNode::EdgeType T, BitVector &Seen) {
+  ControlDependenceNode *BN = const_cast<ControlDependenceNode *>(N);
+  std::vector<ControlDependenceNode *> stack;
+  Seen.set(N->getID());
+  for (ControlDependenceNode::edge_iterator C = BN->begin(), CE = BN->end(); C != CE; ++C)
+    if (C.type() == T && !Seen.test((*C)->getID())) {
+      Seen.set((*C)->getID());
+      if (*C != H)
+	stack.push_back(*C);
+    }
+  while (!stack.empty()) {
+    ControlDependenceNode *X = stack.back();
+    stack.pop_back();
+    for (ControlDependenceNode::edge_iterator C = X->begin(), CE = X->end(); C != CE; ++C)
+      if (!Seen.test((*C)->getID())) {
+	Seen.set((*C)->getID());
+	if (*C != H)
+	  stack.push_back(*C);
+      }
+  }
+}
+
+namespace llvm {
+
+// Only conditional branches are considered; a switch is unswitched one case
+// at a time, and its case edges all carry the same label in the graph.
+void UnswitchCandidates::analyzeLoop(const Loop *L, const ControlDependenceGraphBase &G) {
+  unsigned loopInsts = 0;
+  for (Loop::block_iterator BB = L->block_begin(), E = L->block_end(); BB != E; ++BB)
+    loopInsts += (*BB)->size();
+
+  CandidateList &list = candidates[L];
+  unsigned n = G.getNumNodes();
+  const ControlDependenceNode *header = G.getNode(L->getHeader());
+  for (Loop::block_iterator BB = L->block_begin(), E = L->block_end(); BB != E; ++BB) {
+    const BranchInst *BI = dyn_cast<BranchInst>((*BB)->getTerminator());
+    if (!BI || !BI->isConditional() || isa<Constant>(BI->getCondition()) ||
+	!L->isLoopInvariant(BI->getCondition()))
+      continue;
+    const ControlDependenceNode *N = G.getNode(*BB);
+    if (!N || G.getCollapsedLoop(N))
+      continue;
+
+    BitVector onTrue(n), onFalse(n);
+    markSide(N, header, ControlDependenceNode::TRUE, onTrue);
+    markSide(N, header, ControlDependenceNode::FALSE, onFalse);
+
+    Candidate C;
+    C.Branch = *BB;
+    C.ControlledBlocks = C.ControlledInsts = C.Benefit = 0;
+    for (Loop::block_iterator X = L->block_begin(); X != E; ++X) {
+      const ControlDependenceNode *XN = G.getNode(*X);
+      if (!XN || *X == *BB)
+	continue;
+      bool t = onTrue.test(XN->getID()), f = onFalse.test(XN->getID());
+      if (!t && !f)
+	continue;
+      ++C.ControlledBlocks;
+      C.ControlledInsts += (*X)->size();
+      if (t != f)
+	C.Benefit += (*X)->size();
+    }
+    C.Growth = loopInsts - C.Benefit;
+    if (C.Growth <= Threshold)
+      list.push_back(C);
+  }
+  std::stable_sort(list.begin(), list.end(), MoreBeneficial());
+}
+
+bool UnswitchCandidates::runOnFunction(Function &F) {
+  function = &F;
+  loops.clear();
+  const ControlDependenceGraphBase &G = getAnalysis<ControlDependenceGraph>();
+  LoopInfo &LI = getAnalysis<LoopInfo>();
+
+  // Loops in preorder, outermost first.
+  std::vector<const Loop *> worklist(LI.rbegin(), LI.rend());
+  while (!worklist.empty()) {
+    const Loop *L = worklist.back();
+    worklist.pop_back();
+    loops.push_back(L);
+    if (!G.isApproximate())
+      analyzeLoop(L, G);
+    worklist.insert(worklist.end(), L->getSubLoops().rbegin(), L->getSubLoops().rend());
+  }
+  return false;
+}
+
+const UnswitchCandidates::CandidateList &UnswitchCandidates::getCandidates(const Loop *L) const {
+  static const CandidateList none;
+  DenseMap<const Loop *, CandidateList>::const_iterator C = candidates.find(L);
+  return C == candidates.end() ? none : C->second;
+}
+
+void UnswitchCandidates::print(raw_ostream &OS, const Module *M) const {
+  if (!function)
+    return;
+  OS << "Unswitching candidates for '" << function->getName() << "':\n";
+  for (unsigned i = 0, e = loops.size(); i != e; ++i) {
+    const CandidateList &list = getCandidates(loops[i]);
+    OS << "  loop at depth " << loops[i]->getLoopDepth() << " with header ";
+    loops[i]->getHeader()->printAsOperand(OS, false);
+    OS << ": " << list.size() << " candidates\n";
+    for (unsigned j = 0, je = list.size(); j != je; ++j) {
+      const Candidate &C = list[j];
+      OS << "    ";
+      C.Branch->printAsOperand(OS, false);
+      OS << ": controls " << C.ControlledBlocks << " blocks (" << C.ControlledInsts
+	 << " instructions), benefit " << C.Benefit << ", growth " << C.Growth << '\n';
+    }
+  }
+}
+
+void UnswitchCandidates::getAnalysisUsage(AnalysisUsage &AU) const {
+  AU.addRequired<ControlDependenceGraph>();
+  AU.addRequired<LoopInfo>();
+  AU.setPreservesAll();
+}
+
+} // namespace llvm
+
+char UnswitchCandidates::ID = 0;
+static RegisterPass<UnswitchCandidates> Candidates("unswitch-candidates",
+						   "Find loop-invariant branches worth unswitching",
+						   true, true);
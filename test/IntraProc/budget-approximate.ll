@@ -0,0 +1,19 @@
+; RUN: cdg-bench -stress-blocks=8000 -cdg-memory-budget=1 -stress-output=%t.ll | FileCheck %s --check-prefix=CSV
+; RUN: opt %loadintraproc -module-control-deps -cdg-memory-budget=1 -analyze < %t.ll | FileCheck %s
+
+; Ifs nested 4000 deep need more than a megabyte of nodes and edges, so
+; with a budget of one megabyte the graph is approximate: every block sits
+; in a region of its own under one hub region, and every branch controls the
+; hub.
+
+; CSV: stress,nested_ifs,8000,16002,8002,20000,1,
+
+; CHECK-LABEL: Control dependence graph for 'nested_ifs':
+; CHECK-NEXT: {{^  }}0 REGION: 8001{{$}}
+; CHECK-NEXT: {{^  }}1 <unnamed>: 8001{{$}}
+; CHECK: {{^  }}3999 <unnamed>: 8001{{$}}
+; CHECK-NEXT: {{^  }}4000 <unnamed>:{{$}}
+; CHECK: {{^  }}8001 REGION: 8002 8003
+; CHECK-NEXT: {{^  }}8002 REGION: 1{{$}}
+; CHECK: {{^  }}16001 REGION: 8000{{$}}
+; CHECK-NOT: {{^  }}16002
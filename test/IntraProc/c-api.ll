@@ -0,0 +1,62 @@
+; RUN: cdg-c-view < %s | FileCheck %s
+; RUN: cdg-c-view -hash < %s | FileCheck %s -check-prefix=HASH
+
+; The flat view lists the nodes by ID, root first, with the true, false and
+; other edges of each in that order, each sorted by target. Every lookup
+; agrees with the view, or cdg-c-view fails.
+
+; CHECK-LABEL: Graph of 'diamond': 7 nodes, 6 edges
+; CHECK-NEXT: 0 root: 1 4{{$}}
+; CHECK-NEXT: 1 block 0 %entry: T5 F6{{$}}
+; CHECK-NEXT: 2 block 1 %then:{{$}}
+; CHECK-NEXT: 3 block 2 %else:{{$}}
+; CHECK-NEXT: 4 block 3 %join:{{$}}
+; CHECK-NEXT: 5 region: 2{{$}}
+; CHECK-NEXT: 6 region: 3{{$}}
+; CHECK-NEXT: %entry in region 0
+; CHECK-NEXT: %then in region 5
+; CHECK-NEXT: %else in region 6
+; CHECK-NEXT: %join in region 0
+
+; HASH-LABEL: Graph of 'diamond':
+; HASH-NEXT: 0 root: 1 4 hash {{[0-9a-f]+$}}
+define i32 @diamond(i1 %c) {
+entry:
+  br i1 %c, label %then, label %else
+
+then:
+  br label %join
+
+else:
+  br label %join
+
+join:
+  %r = phi i32 [ 1, %then ], [ 2, %else ]
+  ret i32 %r
+}
+
+; A switch controls each case through an other edge.
+
+; CHECK-LABEL: Graph of 'cases':
+; CHECK-NEXT: 0 root: 1 4{{$}}
+; CHECK-NEXT: 1 block 0 %entry: 5{{$}}
+; CHECK-NEXT: 2 block 1 %one:{{$}}
+; CHECK-NEXT: 3 block 2 %two:{{$}}
+; CHECK-NEXT: 4 block 3 %exit:{{$}}
+; CHECK-NEXT: 5 region: 2 3{{$}}
+define void @cases(i32 %x) {
+entry:
+  switch i32 %x, label %exit [
+    i32 0, label %one
+    i32 1, label %two
+  ]
+
+one:
+  br label %exit
+
+two:
+  br label %exit
+
+exit:
+  ret void
+}
@@ -0,0 +1,51 @@
+; RUN: rm -rf %t.dir && mkdir -p %t.dir/sub
+; RUN: cp %s %t.dir/a.ll
+; RUN: llvm-as < %s > %t.dir/sub/b.bc
+; RUN: echo "not IR" > %t.dir/sub/notes.txt
+; RUN: cdg-bench %t.dir -summary=%t.summary > %t.csv
+; RUN: FileCheck %s < %t.csv
+; RUN: FileCheck %s --check-prefix=SUMMARY < %t.summary
+
+; cdg-bench walks a directory for .ll and .bc files, in path order, skipping
+; anything else, and writes a row per defined function and a summary over
+; the whole corpus.
+
+; CHECK: file,function,blocks,nodes,regions,edges,approximate,tier,time_us,memory_bytes
+; CHECK-NEXT: {{.*}}a.ll,diamond,4,7,3,6,0,small,{{[0-9]+}},{{[0-9]+$}}
+; CHECK-NEXT: {{.*}}a.ll,straight,2,3,1,2,0,trivial,{{[0-9]+}},{{[0-9]+$}}
+; CHECK-NEXT: {{.*}}b.bc,diamond,4,7,3,6,0,small,
+; CHECK-NEXT: {{.*}}b.bc,straight,2,3,1,2,0,trivial,
+; CHECK-NOT: notes
+
+; SUMMARY: metric,count,total,min,p50,p90,p99,max
+; SUMMARY-NEXT: time_us,4,
+; SUMMARY-NEXT: memory_bytes,4,
+; SUMMARY-NEXT: nodes,4,20,3,3,7,7,7
+; SUMMARY-NEXT: regions,4,8,1,1,3,3,3
+; SUMMARY-NEXT: approximate,4,0,,,,,
+
+declare void @ext()
+
+define i32 @diamond(i1 %c) {
+entry:
+  br i1 %c, label %then, label %else
+
+then:
+  br label %join
+
+else:
+  br label %join
+
+join:
+  %r = phi i32 [ 1, %then ], [ 2, %else ]
+  ret i32 %r
+}
+
+define void @straight() {
+entry:
+  call void @ext()
+  br label %exit
+
+exit:
+  ret void
+}
@@ -0,0 +1,48 @@
+; RUN: opt %loadintraproc -function-control-deps -cdg-collapse-loops -analyze < %s | FileCheck %s --check-prefix=COLLAPSED
+; RUN: opt %loadintraproc -control-deps-loops -analyze < %s | FileCheck %s
+
+; With loops collapsed, the outer loop is one node labelled with its header,
+; which the entry controls. Expanding it gives the graph of its body, in
+; which the inner loop is collapsed in turn and the latch controls the whole
+; body; expanding the inner loop gives the graph of a self loop.
+
+; COLLAPSED-LABEL: for function 'nest':
+; COLLAPSED-NEXT: 0 REGION: 1 3
+; COLLAPSED-NEXT: 1 entry: T4
+; COLLAPSED-NEXT: 2 outer (loop):
+; COLLAPSED-NEXT: 3 exit:
+; COLLAPSED-NEXT: 4 REGION: 2
+; COLLAPSED-NOT: REGION
+
+; CHECK-LABEL: for function 'nest':
+; CHECK-NEXT: 0 REGION: 1 3
+; CHECK-NEXT: 1 entry: T4
+; CHECK-NEXT: 2 outer (loop):
+; CHECK-NEXT: 3 exit:
+; CHECK-NEXT: 4 REGION: 2
+; CHECK-NEXT: loop %outer:
+; CHECK-NEXT: 0 REGION: 4
+; CHECK-NEXT: 1 outer:
+; CHECK-NEXT: 2 inner (loop):
+; CHECK-NEXT: 3 latch: T4
+; CHECK-NEXT: 4 REGION: 1 2 3
+; CHECK-NEXT: loop %inner:
+; CHECK-NEXT: 0 REGION: 2
+; CHECK-NEXT: 1 inner: T2
+; CHECK-NEXT: 2 REGION: 1
+define void @nest(i1 %a, i1 %b, i1 %c) {
+entry:
+  br i1 %a, label %outer, label %exit
+
+outer:
+  br label %inner
+
+inner:
+  br i1 %b, label %inner, label %latch
+
+latch:
+  br i1 %c, label %outer, label %exit
+
+exit:
+  ret void
+}
@@ -0,0 +1,48 @@
+; RUN: opt %loadintraproc -module-control-deps -analyze -cdg-min-tier=trivial < %s > %t.trivial
+; RUN: opt %loadintraproc -module-control-deps -analyze -cdg-min-tier=small < %s > %t.small
+; RUN: opt %loadintraproc -module-control-deps -analyze -cdg-min-tier=full < %s > %t.full
+; RUN: diff %t.trivial %t.small
+; RUN: diff %t.small %t.full
+; RUN: FileCheck %s < %t.full
+
+; Every construction tier builds the same graph, node for node. The
+; straight-line function would normally take the trivial tier and the
+; branching one the small tier; both are also built at the tiers above.
+
+; CHECK-LABEL: Control dependence graph for 'straight':
+; CHECK-NEXT: 0 REGION: 1 2 3
+; CHECK-NEXT: 1 entry:
+; CHECK-NEXT: 2 middle:
+; CHECK-NEXT: 3 exit:
+; CHECK: region 0: %entry %middle %exit
+define void @straight() {
+entry:
+  br label %middle
+
+middle:
+  br label %exit
+
+exit:
+  ret void
+}
+
+; CHECK-LABEL: Control dependence graph for 'branchy':
+; CHECK-NEXT: 0 REGION: 1 3 4
+; CHECK-NEXT: 1 entry: T5
+; CHECK-NEXT: 2 then:
+; CHECK-NEXT: 3 join:
+; CHECK-NEXT: 4 exit:
+; CHECK-NEXT: 5 REGION: 2
+define void @branchy(i1 %c) {
+entry:
+  br i1 %c, label %then, label %join
+
+then:
+  br label %join
+
+join:
+  br label %exit
+
+exit:
+  ret void
+}
@@ -0,0 +1,68 @@
+; RUN: opt %loadintraproc -control-deps-controlled -analyze < %s | FileCheck %s
+
+; The printer fills the cached sets from several threads before it prints
+; them, so these must also come out whole when threads race to fill them.
+
+; A branch controls the blocks nested below it, transitively, and a block
+; that two branches lead to belongs to both.
+
+; CHECK-LABEL: Controlled blocks for 'rejoin':
+; CHECK-NEXT: %entry: %left %nested %right %both{{$}}
+; CHECK-NEXT: %left: %nested %both{{$}}
+; CHECK-NEXT: %nested:{{$}}
+; CHECK-NEXT: %right:{{$}}
+; CHECK-NEXT: %both:{{$}}
+; CHECK-NEXT: %exit:{{$}}
+define void @rejoin(i1 %a, i1 %b) {
+entry:
+  br i1 %a, label %left, label %right
+
+left:
+  br i1 %b, label %nested, label %both
+
+nested:
+  br label %exit
+
+right:
+  br label %both
+
+both:
+  br label %exit
+
+exit:
+  ret void
+}
+
+; Each of the loop's branches controls the whole loop, itself included, and
+; the header, which runs on entry, controls nothing.
+
+; CHECK-LABEL: Controlled blocks for 'loop':
+; CHECK-NEXT: %entry:{{$}}
+; CHECK-NEXT: %header:{{$}}
+; CHECK-NEXT: %check: %header %check %body %other{{$}}
+; CHECK-NEXT: %body: %header %check %body %other{{$}}
+; CHECK-NEXT: %other: %header %check %body %other{{$}}
+; CHECK-NEXT: %exit:{{$}}
+define void @loop(i1 %inv, i32 %n) {
+entry:
+  br label %header
+
+header:
+  %i = phi i32 [ 0, %entry ], [ %i.next, %body ], [ %i.next, %other ]
+  %i.next = add i32 %i, 1
+  br label %check
+
+check:
+  br i1 %inv, label %body, label %other
+
+body:
+  %c = icmp eq i32 %i.next, %n
+  br i1 %c, label %exit, label %header
+
+other:
+  %d = icmp eq i32 %i, %n
+  br i1 %d, label %exit, label %header
+
+exit:
+  ret void
+}
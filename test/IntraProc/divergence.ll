@@ -0,0 +1,109 @@
+; RUN: opt %loadintraproc -control-deps-divergence -analyze < %s | FileCheck %s
+
+; Threads differ in what get_local_id returns, and in everything computed
+; from it.
+
+; A branch on the thread id diverges, and the PHI where its sides meet
+; merges values from threads that took different sides.
+
+; CHECK-LABEL: Divergence of 'divergent_if':
+; CHECK-NEXT: values: %tid %c %r{{$}}
+; CHECK-NEXT: branches: %entry{{$}}
+; CHECK-NEXT: join points: %join{{$}}
+define i32 @divergent_if(i32 %x) {
+entry:
+  %tid = call i32 @get_local_id(i32 0)
+  %c = icmp slt i32 %tid, %x
+  br i1 %c, label %then, label %join
+
+then:
+  %y = add i32 %x, 1
+  br label %join
+
+join:
+  %r = phi i32 [ %y, %then ], [ %x, %entry ]
+  ret i32 %r
+}
+
+; All threads take the same side of a branch on an argument, so its join
+; is not a join point, even though one side computes a divergent value.
+
+; CHECK-LABEL: Divergence of 'uniform_if':
+; CHECK-NEXT: values: %tid %y{{$}}
+; CHECK-NEXT: branches:{{$}}
+; CHECK-NEXT: join points:{{$}}
+define i32 @uniform_if(i32 %x) {
+entry:
+  %tid = call i32 @get_local_id(i32 0)
+  %c = icmp slt i32 %x, 0
+  br i1 %c, label %then, label %join
+
+then:
+  %y = add i32 %tid, 1
+  br label %join
+
+join:
+  %r = phi i32 [ 1, %then ], [ 2, %entry ]
+  ret i32 %r
+}
+
+; Threads leave the loop after different numbers of iterations, so the
+; exit is a join point and the value of %i they carry out diverges, though
+; %i is uniform inside the loop.
+
+; CHECK-LABEL: Divergence of 'divergent_exit':
+; CHECK-NEXT: values: %tid %c %r{{$}}
+; CHECK-NEXT: branches: %header{{$}}
+; CHECK-NEXT: join points: %exit{{$}}
+define i32 @divergent_exit(i32 %n) {
+entry:
+  %tid = call i32 @get_local_id(i32 0)
+  br label %header
+
+header:
+  %i = phi i32 [ 0, %entry ], [ %i.next, %header ]
+  %i.next = add i32 %i, 1
+  %c = icmp slt i32 %i.next, %tid
+  br i1 %c, label %header, label %exit
+
+exit:
+  %r = phi i32 [ %i, %header ]
+  ret i32 %r
+}
+
+; Both exits are uniform, but the divergent branch in the header sends some
+; threads around the loop again while others go on to the exits; they leave
+; in different iterations and through different exits.
+
+; CHECK-LABEL: Divergence of 'uniform_exits':
+; CHECK-NEXT: values: %tid %c %r{{$}}
+; CHECK-NEXT: branches: %header{{$}}
+; CHECK-NEXT: join points: %exit{{$}}
+define i32 @uniform_exits(i32 %n, i32 %m) {
+entry:
+  %tid = call i32 @get_local_id(i32 0)
+  br label %header
+
+header:
+  %i = phi i32 [ 0, %entry ], [ %i.next, %latch ]
+  %c = icmp slt i32 %i, %tid
+  br i1 %c, label %first, label %latch
+
+first:
+  %d = icmp eq i32 %i, %n
+  br i1 %d, label %exit, label %second
+
+second:
+  %e = icmp eq i32 %i, %m
+  br i1 %e, label %exit, label %latch
+
+latch:
+  %i.next = add i32 %i, 1
+  br label %header
+
+exit:
+  %r = phi i32 [ 1, %first ], [ 2, %second ]
+  ret i32 %r
+}
+
+declare i32 @get_local_id(i32)
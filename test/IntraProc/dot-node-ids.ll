@@ -0,0 +1,31 @@
+; RUN: rm -rf %t && mkdir -p %t && cd %t
+; RUN: opt %loadintraproc -print-control-deps -disable-output < %s
+; RUN: FileCheck %s < %t/control-deps.diamond.dot
+
+; DOT nodes are named by node ID, never by address.
+
+; CHECK: digraph "Control dependence graph for 'diamond' function" {
+; CHECK-DAG: Node0 [shape=record,label="{ENTRY}"];
+; CHECK-DAG: Node1 [shape=record,label="{entry}"];
+; CHECK-DAG: Node2 [shape=record,label="{then}"];
+; CHECK-DAG: Node3 [shape=record,label="{else}"];
+; CHECK-DAG: Node4 [shape=record,label="{join}"];
+; CHECK-DAG: Node0 -> Node1;
+; CHECK-DAG: Node0 -> Node4;
+; CHECK-DAG: Node1 -> Node{{[0-9]+}} [label="T"];
+; CHECK-DAG: Node1 -> Node{{[0-9]+}} [label="F"];
+; CHECK-NOT: Node0x
+define i32 @diamond(i1 %c) {
+entry:
+  br i1 %c, label %then, label %else
+
+then:
+  br label %join
+
+else:
+  br label %join
+
+join:
+  %r = phi i32 [ 1, %then ], [ 2, %else ]
+  ret i32 %r
+}
@@ -0,0 +1,81 @@
+; RUN: opt %loadintraproc -function-control-deps -analyze < %s | grep -v "^Printing analysis" > %t.ir
+; RUN: opt %loadintraproc -generic-control-deps -analyze < %s > %t.generic
+; RUN: grep -v "^Printing analysis" %t.generic | diff %t.ir -
+; RUN: FileCheck %s < %t.generic
+
+; The engine instantiated over Function through GraphTraits, with
+; post-dominators from PostDominatorTree, builds the same graph as the IR
+; graph, node for node.
+
+; CHECK-LABEL: for function 'diamond':
+; CHECK-NEXT: 0 REGION: 1 4
+; CHECK-NEXT: 1 entry: T5 F6
+; CHECK-NEXT: 2 then:
+; CHECK-NEXT: 3 else:
+; CHECK-NEXT: 4 join:
+; CHECK-NEXT: 5 REGION: 2
+; CHECK-NEXT: 6 REGION: 3
+define void @diamond(i1 %c) {
+entry:
+  br i1 %c, label %then, label %else
+
+then:
+  br label %join
+
+else:
+  br label %join
+
+join:
+  ret void
+}
+
+; The header controls itself and the body, so its true edge leads to a
+; region holding both of their regions.
+
+; CHECK-LABEL: for function 'loop':
+; CHECK-NEXT: 0 REGION: 1 4 6
+; CHECK-NEXT: 1 entry:
+; CHECK-NEXT: 2 header: T7
+; CHECK-NEXT: 3 body:
+; CHECK-NEXT: 4 exit:
+; CHECK-NEXT: 5 REGION: 3
+; CHECK-NEXT: 6 REGION: 2
+; CHECK-NEXT: 7 REGION: 5 6
+define void @loop(i1 %c) {
+entry:
+  br label %header
+
+header:
+  br i1 %c, label %body, label %exit
+
+body:
+  br label %header
+
+exit:
+  ret void
+}
+
+; Cases sharing a destination give one dependence.
+
+; CHECK-LABEL: for function 'switch':
+; CHECK-NEXT: 0 REGION: 1 4
+; CHECK-NEXT: 1 entry: 5
+; CHECK-NEXT: 2 zero:
+; CHECK-NEXT: 3 other:
+; CHECK-NEXT: 4 exit:
+; CHECK-NEXT: 5 REGION: 2 3
+define void @switch(i32 %x) {
+entry:
+  switch i32 %x, label %other [ i32 0, label %zero
+                                i32 1, label %zero
+                                i32 2, label %other ]
+
+zero:
+  br label %exit
+
+other:
+  br label %exit
+
+exit:
+  ret void
+}
@@ -0,0 +1,110 @@
+; RUN: opt %loadintraproc -function-control-deps -cdg-hash-regions -analyze < %s | FileCheck %s
+
+; Functions that differ only in a comparison predicate, a floating-point
+; constant or a wrap flag get different hashes for the block that holds the
+; change and for the nodes above it, while the nodes of unchanged blocks
+; keep theirs; an identical copy gets the same hashes throughout.
+
+; CHECK-LABEL: for function 'base':
+; CHECK: hash 0: [[ROOT:[0-9a-f]+]]
+; CHECK-NEXT: hash 1: [[ENTRY:[0-9a-f]+]]
+; CHECK-NEXT: hash 2: [[THEN:[0-9a-f]+]]
+; CHECK-NEXT: hash 3: [[EXIT:[0-9a-f]+]]
+define double @base(i32 %a, i32 %b, double %x) {
+entry:
+  %c = icmp slt i32 %a, %b
+  br i1 %c, label %then, label %exit
+
+then:
+  %s = add i32 %a, 1
+  %y = fadd double %x, 1.0
+  br label %exit
+
+exit:
+  %r = phi double [ %x, %entry ], [ %y, %then ]
+  ret double %r
+}
+
+; CHECK-LABEL: for function 'copy':
+; CHECK: hash 0: [[ROOT]]
+; CHECK-NEXT: hash 1: [[ENTRY]]
+; CHECK-NEXT: hash 2: [[THEN]]
+; CHECK-NEXT: hash 3: [[EXIT]]
+define double @copy(i32 %a, i32 %b, double %x) {
+entry:
+  %c = icmp slt i32 %a, %b
+  br i1 %c, label %then, label %exit
+
+then:
+  %s = add i32 %a, 1
+  %y = fadd double %x, 1.0
+  br label %exit
+
+exit:
+  %r = phi double [ %x, %entry ], [ %y, %then ]
+  ret double %r
+}
+
+; CHECK-LABEL: for function 'predicate':
+; CHECK: hash 0:
+; CHECK-NOT: [[ROOT]]
+; CHECK: hash 1:
+; CHECK-NOT: [[ENTRY]]
+; CHECK: hash 2: [[THEN]]
+; CHECK-NEXT: hash 3: [[EXIT]]
+define double @predicate(i32 %a, i32 %b, double %x) {
+entry:
+  %c = icmp sgt i32 %a, %b
+  br i1 %c, label %then, label %exit
+
+then:
+  %s = add i32 %a, 1
+  %y = fadd double %x, 1.0
+  br label %exit
+
+exit:
+  %r = phi double [ %x, %entry ], [ %y, %then ]
+  ret double %r
+}
+
+; CHECK-LABEL: for function 'fp_constant':
+; CHECK: hash 0:
+; CHECK-NOT: [[ROOT]]
+; CHECK: hash 2:
+; CHECK-NOT: [[THEN]]
+; CHECK: hash 3: [[EXIT]]
+define double @fp_constant(i32 %a, i32 %b, double %x) {
+entry:
+  %c = icmp slt i32 %a, %b
+  br i1 %c, label %then, label %exit
+
+then:
+  %s = add i32 %a, 1
+  %y = fadd double %x, 2.0
+  br label %exit
+
+exit:
+  %r = phi double [ %x, %entry ], [ %y, %then ]
+  ret double %r
+}
+
+; CHECK-LABEL: for function 'wrap_flag':
+; CHECK: hash 0:
+; CHECK-NOT: [[ROOT]]
+; CHECK: hash 2:
+; CHECK-NOT: [[THEN]]
+; CHECK: hash 3: [[EXIT]]
+define double @wrap_flag(i32 %a, i32 %b, double %x) {
+entry:
+  %c = icmp slt i32 %a, %b
+  br i1 %c, label %then, label %exit
+
+then:
+  %s = add nsw i32 %a, 1
+  %y = fadd double %x, 1.0
+  br label %exit
+
+exit:
+  %r = phi double [ %x, %entry ], [ %y, %then ]
+  ret double %r
+}
@@ -0,0 +1,45 @@
+; RUN: opt %loadintraproc -control-deps-ancestors -analyze < %s | FileCheck %s
+
+; Walks over the inverse graph start at a node, since no node reaches the
+; whole graph along parent edges. From every block of the loop the walk goes
+; around the cycle through the latches %body and %other, and it ends at the
+; root, which has no parents.
+
+;  0 REGION: 1 6 7
+;  3 check: T8 F9
+;  4 body: F7
+;  5 other: F7
+;  7 REGION: 2 3
+;  8 REGION: 4
+;  9 REGION: 5
+
+; CHECK-LABEL: for function 'loop':
+; CHECK-NEXT: 1 entry: 0 1{{$}}
+; CHECK-NEXT: 2 header: 0 3 8 4 9 5 7 2{{$}}
+; CHECK-NEXT: 3 check: 0 8 4 9 5 7 3{{$}}
+; CHECK-NEXT: 4 body: 0 9 5 7 3 8 4{{$}}
+; CHECK-NEXT: 5 other: 0 8 4 7 3 9 5{{$}}
+; CHECK-NEXT: 6 exit: 0 6{{$}}
+define void @loop(i1 %inv, i32 %n) {
+entry:
+  br label %header
+
+header:
+  %i = phi i32 [ 0, %entry ], [ %i.next, %body ], [ %i.next, %other ]
+  %i.next = add i32 %i, 1
+  br label %check
+
+check:
+  br i1 %inv, label %body, label %other
+
+body:
+  %c = icmp eq i32 %i.next, %n
+  br i1 %c, label %exit, label %header
+
+other:
+  %d = icmp eq i32 %i, %n
+  br i1 %d, label %exit, label %header
+
+exit:
+  ret void
+}
@@ -0,0 +1,65 @@
+; RUN: cdg-llc -mtriple=x86_64-unknown-linux-gnu < %s | FileCheck %s
+; REQUIRES: x86-registered-target
+
+; The machine graph is built from the code the target emits. Without
+; optimization the blocks keep their order, and each branch is a conditional
+; jump to the true side followed by a jump or fall-through to the false side.
+
+; CHECK-LABEL: Machine control dependence graph for 'diamond':
+; CHECK-NEXT: 0 REGION: 1 4
+; CHECK-NEXT: 1 BB#0: T5 F6
+; CHECK-NEXT: 2 BB#1:
+; CHECK-NEXT: 3 BB#2:
+; CHECK-NEXT: 4 BB#3:
+; CHECK-NEXT: 5 REGION: 2
+; CHECK-NEXT: 6 REGION: 3
+define void @diamond(i1 %x) {
+entry:
+  br i1 %x, label %then, label %else
+
+then:
+  call void @a()
+  br label %join
+
+else:
+  call void @b()
+  br label %join
+
+join:
+  call void @c()
+  ret void
+}
+
+; The header jumps to the exit when the loop is done and falls through to the
+; body otherwise, so it controls itself on its false edge.
+
+; CHECK-LABEL: Machine control dependence graph for 'loop':
+; CHECK-NEXT: 0 REGION: 1 4 6
+; CHECK-NEXT: 1 BB#0:
+; CHECK-NEXT: 2 BB#1: F7
+; CHECK-NEXT: 3 BB#2:
+; CHECK-NEXT: 4 BB#3:
+; CHECK-NEXT: 5 REGION: 3
+; CHECK-NEXT: 6 REGION: 2
+; CHECK-NEXT: 7 REGION: 5 6
+define void @loop(i32 %n) {
+entry:
+  br label %header
+
+header:
+  %i = phi i32 [ 0, %entry ], [ %i.next, %body ]
+  %c = icmp slt i32 %i, %n
+  br i1 %c, label %body, label %exit
+
+body:
+  call void @a()
+  %i.next = add i32 %i, 1
+  br label %header
+
+exit:
+  ret void
+}
+
+declare void @a()
+declare void @b()
+declare void @c()
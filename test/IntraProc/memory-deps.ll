@@ -0,0 +1,55 @@
+; RUN: opt %loadintraproc -basicaa -memory-deps -analyze < %s | FileCheck %s
+
+; The region of the entry block is the root, so a query from the entry block
+; fills in every block that runs whenever the function does. The load in
+; %then lies in a region of its own and finds the load in %entry across the
+; branch, since loads of the same location define each other.
+
+; CHECK-LABEL: Memory dependences for 'entry_load':
+; CHECK-NEXT: store i32 1, i32* %p
+; CHECK-NEXT: %v = load i32* %p
+; CHECK-NEXT: <- store i32 1, i32* %p
+; CHECK-NEXT: %w = load i32* %p
+; CHECK-NEXT: <- %v = load i32* %p
+; CHECK-NOT: unknown
+define i32 @entry_load(i32* %p, i1 %c) {
+entry:
+  store i32 1, i32* %p
+  %v = load i32* %p
+  br i1 %c, label %then, label %exit
+
+then:
+  %w = load i32* %p
+  br label %exit
+
+exit:
+  ret i32 %v
+}
+
+; A load after a branch depends on the stores on both sides. Those come back
+; from MemoryDependenceAnalysis in the order it keeps their blocks, and are
+; listed in program order.
+
+; CHECK-LABEL: Memory dependences for 'two_stores':
+; CHECK-NEXT: store i32 1, i32* %p
+; CHECK-NEXT: store i32 2, i32* %p
+; CHECK-NEXT: %v = load i32* %p
+; CHECK-NEXT: <- store i32 1, i32* %p
+; CHECK-NEXT: <- store i32 2, i32* %p
+; CHECK-NOT: unknown
+define i32 @two_stores(i32* %p, i1 %c) {
+entry:
+  br i1 %c, label %then, label %else
+
+then:
+  store i32 1, i32* %p
+  br label %join
+
+else:
+  store i32 2, i32* %p
+  br label %join
+
+join:
+  %v = load i32* %p
+  ret i32 %v
+}
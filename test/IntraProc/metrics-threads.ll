@@ -0,0 +1,101 @@
+; RUN: opt %loadintraproc -cdg-metrics -cdg-metrics-threads=1 -cdg-metrics-output=%t.one -disable-output < %s
+; RUN: opt %loadintraproc -cdg-metrics -cdg-metrics-threads=4 -cdg-metrics-output=%t.four -disable-output < %s
+; RUN: diff %t.one %t.four
+; RUN: FileCheck %s < %t.four
+
+; Functions are handed out to the threads as they finish, but the rows come
+; out in module order, and with the same values, however many threads
+; computed them.
+
+; CHECK: function,blocks,regions,decisions,max_depth,max_fanout,fanout_1,fanout_2,fanout_3_4,fanout_5_8,fanout_9_plus,largest_class,approximate
+; CHECK-NEXT: straight,1,1,0,0,0,0,0,0,0,0,1,0{{$}}
+; CHECK-NEXT: diamond,4,3,1,1,2,0,1,0,0,0,2,0{{$}}
+; CHECK-NEXT: nested,5,4,3,3,1,3,0,0,0,0,2,0{{$}}
+; CHECK-NEXT: loop,4,4,1,1,1,1,0,0,0,0,2,0{{$}}
+; CHECK-NEXT: cases,5,2,1,1,1,1,0,0,0,0,3,0{{$}}
+; CHECK-NEXT: after_declaration,3,2,1,1,1,1,0,0,0,0,2,0{{$}}
+; CHECK-NOT: {{.}}
+define void @straight() {
+entry:
+  ret void
+}
+
+define void @diamond(i1 %a) {
+entry:
+  br i1 %a, label %then, label %else
+
+then:
+  br label %join
+
+else:
+  br label %join
+
+join:
+  ret void
+}
+
+define void @nested(i1 %a, i1 %b, i1 %c) {
+entry:
+  br i1 %a, label %one, label %exit
+
+one:
+  br i1 %b, label %two, label %exit
+
+two:
+  br i1 %c, label %three, label %exit
+
+three:
+  br label %exit
+
+exit:
+  ret void
+}
+
+define void @loop(i1 %a) {
+entry:
+  br label %header
+
+header:
+  br i1 %a, label %body, label %exit
+
+body:
+  br label %header
+
+exit:
+  ret void
+}
+
+define void @cases(i32 %x) {
+entry:
+  switch i32 %x, label %exit [
+    i32 0, label %one
+    i32 1, label %two
+    i32 2, label %three
+  ]
+
+one:
+  br label %exit
+
+two:
+  br label %exit
+
+three:
+  br label %exit
+
+exit:
+  ret void
+}
+
+declare void @external()
+
+define void @after_declaration(i1 %a) {
+entry:
+  br i1 %a, label %then, label %exit
+
+then:
+  call void @external()
+  br label %exit
+
+exit:
+  ret void
+}
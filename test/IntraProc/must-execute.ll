@@ -0,0 +1,97 @@
+; RUN: opt %loadintraproc -must-execute -analyze < %s | FileCheck %s
+; RUN: opt %loadintraproc -must-execute -cdg-regions-only -analyze < %s | FileCheck %s
+
+; Blocks that every entry of the function reaches always execute, and so do
+; the calls in them; blocks under a condition do not.
+
+declare void @a()
+declare void @b()
+declare void @c()
+
+; CHECK-LABEL: Must-execute summary for 'diamond':
+; CHECK-NEXT: blocks: %entry %join{{$}}
+; CHECK-NEXT: calls: a c{{$}}
+define void @diamond(i1 %x) {
+entry:
+  call void @a()
+  br i1 %x, label %then, label %else
+
+then:
+  call void @b()
+  br label %join
+
+else:
+  br label %join
+
+join:
+  call void @c()
+  ret void
+}
+
+; CHECK-LABEL: Must-execute summary for 'caller':
+; CHECK-NEXT: blocks: %entry{{$}}
+; CHECK-NEXT: calls: a c diamond{{$}}
+define void @caller(i1 %x) {
+entry:
+  call void @diamond(i1 %x)
+  ret void
+}
+
+; Summaries propagate through chains of calls: @top always calls @caller, and
+; so everything @caller always calls, but not @b, which @diamond only calls
+; under a condition, nor @guarded, which @top calls under a condition.
+
+; CHECK-LABEL: Must-execute summary for 'top':
+; CHECK-NEXT: blocks: %entry %exit{{$}}
+; CHECK-NEXT: calls: a c diamond caller{{$}}
+define void @top(i1 %x) {
+entry:
+  call void @caller(i1 %x)
+  br i1 %x, label %then, label %exit
+
+then:
+  call void @guarded()
+  br label %exit
+
+exit:
+  ret void
+}
+
+define void @guarded() {
+entry:
+  call void @b()
+  ret void
+}
+
+; Mutually recursive functions are iterated to a fixed point: each always
+; calls the other, itself through the other, and whatever either always
+; calls outside the cycle.
+
+; CHECK-LABEL: Must-execute summary for 'ping':
+; CHECK-NEXT: blocks: %entry{{$}}
+; CHECK-NEXT: calls: a c ping pong{{$}}
+; CHECK-LABEL: Must-execute summary for 'pong':
+; CHECK-NEXT: blocks: %entry %done{{$}}
+; CHECK-NEXT: calls: a c ping pong{{$}}
+define void @ping(i32 %n) {
+entry:
+  call void @a()
+  call void @pong(i32 %n)
+  ret void
+}
+
+define void @pong(i32 %n) {
+entry:
+  %stop = icmp eq i32 %n, 0
+  br i1 %stop, label %done, label %more
+
+more:
+  %m = sub i32 %n, 1
+  br label %done
+
+done:
+  %k = phi i32 [ 0, %entry ], [ %m, %more ]
+  call void @c()
+  call void @ping(i32 %k)
+  ret void
+}
@@ -0,0 +1,29 @@
+; RUN: opt %loadintraproc -control-deps-observers -cdg-hash-regions -analyze < %s | FileCheck %s
+
+; Every node of a finished graph is announced in ID order. Rebuilding the
+; graph first reports that it is invalidated and then removes every old node,
+; whose hash can still be read, before the new nodes are announced; releasing
+; it does the same without announcing anything.
+
+; CHECK-LABEL: for function 'diamond':
+; CHECK-NEXT: added: 0 1 2 3 4 5 6{{$}}
+; CHECK-NEXT: invalidated{{$}}
+; CHECK-NEXT: removed: 0 1 2 3 4 5 6{{$}}
+; CHECK-NEXT: added: 0 1 2 3 4 5 6{{$}}
+; CHECK-NEXT: invalidated{{$}}
+; CHECK-NEXT: removed: 0 1 2 3 4 5 6{{$}}
+; CHECK-NOT: {{.}}
+define i32 @diamond(i1 %c) {
+entry:
+  br i1 %c, label %then, label %else
+
+then:
+  br label %join
+
+else:
+  br label %join
+
+join:
+  %r = phi i32 [ 1, %then ], [ 2, %else ]
+  ret i32 %r
+}
@@ -0,0 +1,138 @@
+; RUN: opt %loadintraproc -path-conditions -analyze < %s | FileCheck %s
+
+; A nested branch's condition is built on its region's: the inner block
+; runs when both branches take their true edges. The rest of the outer side
+; shares the outer region's condition object.
+
+; CHECK-LABEL: Path conditions for 'nested':
+; CHECK-NEXT: c0 = true
+; CHECK-NEXT: c1 = entry.T
+; CHECK-NEXT: c2 = outer.T
+; CHECK-NEXT: c3 = c1 & c2
+; CHECK-NEXT: region 0: c0
+; CHECK-NEXT: region 1: c1
+; CHECK-NEXT: region 2: c3
+; CHECK-NEXT: %entry: c0
+; CHECK-NEXT: %outer: c1
+; CHECK-NEXT: %inner: c3
+; CHECK-NEXT: %outer_end: c1
+; CHECK-NEXT: %exit: c0
+define void @nested(i1 %a, i1 %b) {
+entry:
+  br i1 %a, label %outer, label %exit
+
+outer:
+  br i1 %b, label %inner, label %outer_end
+
+inner:
+  br label %outer_end
+
+outer_end:
+  br label %exit
+
+exit:
+  ret void
+}
+
+; A block two branches lead to runs under the disjunction of their paths.
+; The condition of %left is the same object the rejoining disjunct is built
+; on.
+
+; CHECK-LABEL: Path conditions for 'rejoin':
+; CHECK-NEXT: c0 = true
+; CHECK-NEXT: c1 = entry.T
+; CHECK-NEXT: c2 = entry.F
+; CHECK-NEXT: c3 = left.T
+; CHECK-NEXT: c4 = c1 & c3
+; CHECK-NEXT: c5 = c2 | c4
+; CHECK-NEXT: region 0: c0
+; CHECK-NEXT: region 1: c1
+; CHECK-NEXT: region 2: c2
+; CHECK-NEXT: region 3: c5
+; CHECK-NEXT: %entry: c0
+; CHECK-NEXT: %left: c1
+; CHECK-NEXT: %right: c2
+; CHECK-NEXT: %both: c5
+; CHECK-NEXT: %exit: c0
+define void @rejoin(i1 %a, i1 %b) {
+entry:
+  br i1 %a, label %left, label %right
+
+left:
+  br i1 %b, label %both, label %exit
+
+right:
+  br label %both
+
+both:
+  br label %exit
+
+exit:
+  ret void
+}
+
+; Regions are taken breadth-first, and %join comes before the region of
+; %second, which is nested deeper. Its disjunct from %second is then the
+; literal alone, weaker than the path entry.T & first.T & second.T.
+
+; CHECK-LABEL: Path conditions for 'deeper':
+; CHECK-NEXT: c0 = true
+; CHECK-NEXT: c1 = entry.T
+; CHECK-NEXT: c2 = entry.F
+; CHECK-NEXT: c3 = second.T
+; CHECK-NEXT: c4 = c2 | c3
+; CHECK-NEXT: c5 = first.T
+; CHECK-NEXT: c6 = c1 & c5
+; CHECK-NEXT: region 0: c0
+; CHECK-NEXT: region 1: c1
+; CHECK-NEXT: region 2: c6
+; CHECK-NEXT: region 3: c4
+; CHECK-NEXT: %entry: c0
+; CHECK-NEXT: %first: c1
+; CHECK-NEXT: %second: c6
+; CHECK-NEXT: %join: c4
+; CHECK-NEXT: %exit: c0
+define void @deeper(i1 %a, i1 %b, i1 %c) {
+entry:
+  br i1 %a, label %first, label %join
+
+first:
+  br i1 %b, label %second, label %exit
+
+second:
+  br i1 %c, label %join, label %exit
+
+join:
+  br label %exit
+
+exit:
+  ret void
+}
+
+; The latch closes the loop from its own region, which has no condition yet
+; either, so it contributes its literal alone.
+
+; CHECK-LABEL: Path conditions for 'loop':
+; CHECK-NEXT: c0 = true
+; CHECK-NEXT: c1 = entry.T
+; CHECK-NEXT: c2 = latch.T
+; CHECK-NEXT: c3 = c1 | c2
+; CHECK-NEXT: region 0: c0
+; CHECK-NEXT: region 1: c3
+; CHECK-NEXT: %entry: c0
+; CHECK-NEXT: %header: c3
+; CHECK-NEXT: %latch: c3
+; CHECK-NEXT: %exit: c0
+define void @loop(i1 %a, i1 %b) {
+entry:
+  br i1 %a, label %header, label %exit
+
+header:
+  br label %latch
+
+latch:
+  br i1 %b, label %header, label %exit
+
+exit:
+  ret void
+}
@@ -0,0 +1,89 @@
+; RUN: opt %loadintraproc -function-control-deps -analyze < %s | grep -v "^Printing analysis" > %t.builder
+; RUN: opt %loadintraproc -function-control-deps -cdg-post-dom-tree -analyze < %s > %t.tree
+; RUN: grep -v "^Printing analysis" %t.tree | diff %t.builder -
+; RUN: FileCheck %s < %t.tree
+
+; The in-library Semi-NCA builder and PostDominatorTree give the same
+; post-dominators, and so the same graph, on loops with several exits, on
+; functions with several returns and on an irreducible loop.
+
+; CHECK-LABEL: for function 'loop_exits':
+; CHECK-NEXT: 0 REGION: 1 6 7
+; CHECK-NEXT: 1 entry:
+; CHECK-NEXT: 2 header: T8
+; CHECK-NEXT: 3 body: T10 F9
+; CHECK-NEXT: 4 latch: T7
+; CHECK-NEXT: 5 break:
+; CHECK-NEXT: 6 exit:
+; CHECK-NEXT: 7 REGION: 2
+; CHECK-NEXT: 8 REGION: 3
+; CHECK-NEXT: 9 REGION: 4
+; CHECK-NEXT: 10 REGION: 5
+define void @loop_exits(i1 %a, i1 %b, i1 %c) {
+entry:
+  br label %header
+
+header:
+  br i1 %a, label %body, label %exit
+
+body:
+  br i1 %b, label %break, label %latch
+
+latch:
+  br i1 %c, label %header, label %exit
+
+break:
+  br label %exit
+
+exit:
+  ret void
+}
+
+; CHECK-LABEL: for function 'two_returns':
+; CHECK-NEXT: 0 REGION: 1{{$}}
+; CHECK-NEXT: 1 entry: T6 F7
+; CHECK-NEXT: 2 early:
+; CHECK-NEXT: 3 next: T8
+; CHECK-NEXT: 4 then:
+; CHECK-NEXT: 5 join:
+; CHECK-NEXT: 6 REGION: 2
+; CHECK-NEXT: 7 REGION: 3 5
+; CHECK-NEXT: 8 REGION: 4
+define i32 @two_returns(i1 %a, i1 %b) {
+entry:
+  br i1 %a, label %early, label %next
+
+early:
+  ret i32 0
+
+next:
+  br i1 %b, label %then, label %join
+
+then:
+  br label %join
+
+join:
+  ret i32 1
+}
+
+; CHECK-LABEL: for function 'irreducible':
+; CHECK-NEXT: 0 REGION: 1 4
+; CHECK-NEXT: 1 entry: T5 F6
+; CHECK-NEXT: 2 left: T6
+; CHECK-NEXT: 3 right: T5
+; CHECK-NEXT: 4 exit:
+; CHECK-NEXT: 5 REGION: 2
+; CHECK-NEXT: 6 REGION: 3
+define void @irreducible(i1 %a, i1 %b, i1 %c) {
+entry:
+  br i1 %a, label %left, label %right
+
+left:
+  br i1 %b, label %right, label %exit
+
+right:
+  br i1 %c, label %left, label %exit
+
+exit:
+  ret void
+}
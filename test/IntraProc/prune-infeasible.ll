@@ -0,0 +1,63 @@
+; RUN: opt %loadintraproc -function-control-deps -cdg-prune-infeasible -analyze < %s | grep -v "^Printing analysis" > %t.builder
+; RUN: opt %loadintraproc -function-control-deps -cdg-prune-infeasible -cdg-post-dom-tree -analyze < %s > %t.tree
+; RUN: grep -v "^Printing analysis" %t.tree | diff %t.builder -
+; RUN: FileCheck %s < %t.tree
+
+; Once the untaken edges of constant branches and switches are pruned, the
+; taken successor post-dominates the branch, which then controls nothing.
+; The post-dominators are those of the pruned CFG whether they come from
+; the in-library builder or from PostDominatorTree, so both build the same
+; graph. Blocks that no feasible edge reaches are left in regions that
+; nothing controls.
+
+; CHECK-LABEL: for function 'const_branch':
+; CHECK-NEXT: 0 REGION: 1 2 5
+; CHECK-NEXT: 1 entry:{{$}}
+; CHECK-NEXT: 2 taken: T7
+; CHECK-NEXT: 3 then:
+; CHECK-NEXT: 4 dead:
+; CHECK-NEXT: 5 exit:
+; CHECK-NEXT: 6 REGION: 4
+; CHECK-NEXT: 7 REGION: 3
+define void @const_branch(i1 %c) {
+entry:
+  br i1 true, label %taken, label %dead
+
+taken:
+  br i1 %c, label %then, label %exit
+
+then:
+  br label %exit
+
+dead:
+  br label %exit
+
+exit:
+  ret void
+}
+
+; CHECK-LABEL: for function 'const_switch':
+; CHECK-NEXT: 0 REGION: 1 3 5
+; CHECK-NEXT: 1 entry:{{$}}
+; CHECK-NEXT: 2 one:
+; CHECK-NEXT: 3 two:
+; CHECK-NEXT: 4 other:
+; CHECK-NEXT: 5 exit:
+; CHECK-NEXT: 6 REGION: 2 4
+define void @const_switch(i32 %n) {
+entry:
+  switch i32 2, label %other [ i32 1, label %one
+                               i32 2, label %two ]
+
+one:
+  br label %exit
+
+two:
+  br label %exit
+
+other:
+  br label %exit
+
+exit:
+  ret void
+}
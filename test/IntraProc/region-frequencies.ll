@@ -0,0 +1,71 @@
+; RUN: opt %loadintraproc -region-frequencies -analyze < %s | FileCheck %s
+
+; The sides of a diamond run as often as the branch takes their edges, and
+; the join as often as the branch itself.
+
+; CHECK-LABEL: Region frequencies for 'diamond':
+; CHECK-NEXT: entry: 1{{$}}
+; CHECK-NEXT: then: 0.75{{$}}
+; CHECK-NEXT: else: 0.25{{$}}
+; CHECK-NEXT: join: 1{{$}}
+define void @diamond(i1 %a) {
+entry:
+  br i1 %a, label %then, label %else, !prof !0
+
+then:
+  br label %join
+
+else:
+  br label %join
+
+join:
+  ret void
+}
+
+; The loop is entered 0.75 times, and its latch branches back with
+; probability 7/8, so it runs 1 / (1 - 7/8) = 8 times per entry.
+
+; CHECK-LABEL: Region frequencies for 'loop':
+; CHECK-NEXT: entry: 1{{$}}
+; CHECK-NEXT: header: 6{{$}}
+; CHECK-NEXT: latch: 6{{$}}
+; CHECK-NEXT: exit: 1{{$}}
+define void @loop(i1 %a, i1 %b) {
+entry:
+  br i1 %a, label %header, label %exit, !prof !0
+
+header:
+  br label %latch
+
+latch:
+  br i1 %b, label %header, label %exit, !prof !1
+
+exit:
+  ret void
+}
+
+; A loop that almost never exits would run about a million times per entry;
+; the estimate stops at 4096.
+
+; CHECK-LABEL: Region frequencies for 'hot_loop':
+; CHECK-NEXT: entry: 1{{$}}
+; CHECK-NEXT: header: 4096{{$}}
+; CHECK-NEXT: latch: 4096{{$}}
+; CHECK-NEXT: exit: 1{{$}}
+define void @hot_loop(i1 %b) {
+entry:
+  br label %header
+
+header:
+  br label %latch
+
+latch:
+  br i1 %b, label %header, label %exit, !prof !2
+
+exit:
+  ret void
+}
+
+!0 = metadata !{metadata !"branch_weights", i32 3, i32 1}
+!1 = metadata !{metadata !"branch_weights", i32 7, i32 1}
+!2 = metadata !{metadata !"branch_weights", i32 1000000, i32 1}
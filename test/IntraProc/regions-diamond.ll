@@ -0,0 +1,44 @@
+; RUN: opt %loadintraproc -module-control-deps -analyze < %s | FileCheck %s
+; RUN: opt %loadintraproc -module-control-deps -cdg-regions-only -analyze < %s | FileCheck %s
+
+; Blocks that only the function entry controls stay in the root region, in
+; both the full graph and the region-only summary.
+
+; CHECK-LABEL: regions of function 'diamond':
+; CHECK-NEXT: region 0: %entry %join
+; CHECK-NEXT: region 1, parent 0: %then
+; CHECK-NEXT: controlled by %entry (true)
+; CHECK-NEXT: region 2, parent 0: %else
+; CHECK-NEXT: controlled by %entry (false)
+define i32 @diamond(i1 %c) {
+entry:
+  br i1 %c, label %then, label %else
+
+then:
+  br label %join
+
+else:
+  br label %join
+
+join:
+  %r = phi i32 [ 1, %then ], [ 2, %else ]
+  ret i32 %r
+}
+
+; The loop header runs on entry and again whenever it branches back to itself.
+
+; CHECK-LABEL: regions of function 'self_loop':
+; CHECK-NEXT: region 0: %entry %exit
+; CHECK-NEXT: region 1, parent 0: %header
+; CHECK-DAG: controlled by function entry
+; CHECK-DAG: controlled by %header (true)
+define void @self_loop(i1 %c) {
+entry:
+  br label %header
+
+header:
+  br i1 %c, label %header, label %exit
+
+exit:
+  ret void
+}
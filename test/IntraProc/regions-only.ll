@@ -0,0 +1,96 @@
+; RUN: opt %loadintraproc -module-control-deps -analyze < %s | grep -e region -e controlled > %t.graph
+; RUN: opt %loadintraproc -module-control-deps -cdg-regions-only -analyze < %s | grep -e region -e controlled > %t.only
+; RUN: diff %t.graph %t.only
+; RUN: FileCheck %s < %t.only
+; RUN: opt %loadintraproc -module-control-deps -cdg-collapse-loops -analyze < %s | grep -e region -e controlled > %t.graph
+; RUN: opt %loadintraproc -module-control-deps -cdg-collapse-loops -cdg-regions-only -analyze < %s | grep -e region -e controlled > %t.only
+; RUN: diff %t.graph %t.only
+
+; Regions-only summaries are built without the graph, and must match the
+; summaries made from it, controllers and their order included.
+
+; The loop header runs on entry and whenever %check branches back to it,
+; while the rest of the loop runs when the header does not leave.
+
+; CHECK-LABEL: regions of function 'two_exits':
+; CHECK-NEXT: region 0: %entry %done
+; CHECK-NEXT: region 1, parent 0: %header
+; CHECK-NEXT: controlled by function entry
+; CHECK-NEXT: controlled by %check (true)
+; CHECK-NEXT: region 2, parent 1: %latch %check
+; CHECK-NEXT: controlled by %header (false)
+; CHECK-NEXT: region 3, parent 2: %check_false
+; CHECK-NEXT: controlled by %check (false)
+define void @two_exits(i1 %a, i1 %b, i1 %c) {
+entry:
+  br label %header
+
+header:
+  br i1 %a, label %done, label %latch
+
+latch:
+  br label %check
+
+check:
+  br i1 %b, label %header, label %check_false
+
+check_false:
+  br label %done
+
+done:
+  ret void
+}
+
+; Switch edges are all labelled other, so the blocks of different cases
+; share a region.
+
+; CHECK-LABEL: regions of function 'cases':
+; CHECK-NEXT: region 0: %entry %exit
+; CHECK-NEXT: region 1, parent 0: %one %two
+; CHECK-NEXT: controlled by %entry (other)
+define void @cases(i32 %x) {
+entry:
+  switch i32 %x, label %exit [
+    i32 0, label %one
+    i32 1, label %one
+    i32 2, label %two
+  ]
+
+one:
+  br label %exit
+
+two:
+  br label %exit
+
+exit:
+  ret void
+}
+
+; A nest of loops, which -cdg-collapse-loops folds into single vertices.
+; Without it, the inner loop has three controllers.
+
+; CHECK-LABEL: regions of function 'nest':
+; CHECK-NEXT: region 0: %entry %exit
+; CHECK-NEXT: region 1, parent 0: %outer %latch
+; CHECK-NEXT: controlled by %entry (true)
+; CHECK-NEXT: controlled by %latch (true)
+; CHECK-NEXT: region 2, parent 0: %inner
+; CHECK-NEXT: controlled by %entry (true)
+; CHECK-NEXT: controlled by %inner (true)
+; CHECK-NEXT: controlled by %latch (true)
+define void @nest(i1 %a, i1 %b, i1 %c) {
+entry:
+  br i1 %c, label %outer, label %exit
+
+outer:
+  br label %inner
+
+inner:
+  br i1 %a, label %inner, label %latch
+
+latch:
+  br i1 %b, label %outer, label %exit
+
+exit:
+  ret void
+}
@@ -0,0 +1,16 @@
+; RUN: cdg-bench -stress-blocks=2000 -stress-output=%t.ll | FileCheck %s --check-prefix=CSV
+; RUN: opt %loadintraproc -module-control-deps -analyze < %t.ll | FileCheck %s --check-prefix=PASS
+
+; Ifs and loops nested 1000 deep must neither overflow the stack nor lose
+; nodes. Nested ifs give the root, 2000 blocks and one region per inner if;
+; nested loops give the root, 2002 blocks and one region per loop.
+
+; CSV: stress,nested_ifs,2000,3000,1000,2999,0,full,
+; CSV: stress,nested_loops,2002,3003,1001,4002,0,full,
+
+; PASS-LABEL: Control dependence graph for 'nested_ifs':
+; PASS: {{^  }}2999 REGION:
+; PASS-NOT: {{^  }}3000
+; PASS-LABEL: Control dependence graph for 'nested_loops':
+; PASS: {{^  }}3002 REGION:
+; PASS-NOT: {{^  }}3003
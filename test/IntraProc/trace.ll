@@ -0,0 +1,42 @@
+; RUN: rm -f %t.json
+; RUN: opt %loadintraproc -function-control-deps -cdg-trace=%t.json -analyze < %s > /dev/null
+; RUN: FileCheck %s < %t.json
+
+; -cdg-trace writes a JSON array of Chrome trace complete events, one per
+; construction phase and one around the whole construction of each function.
+; Function names are escaped as JSON strings.
+
+; CHECK: {{^\[$}}
+; CHECK-NEXT: {"name":"postDominators","cat":"cdg","ph":"X","pid":1,"tid":1,"ts":{{[0-9]+}},"dur":{{[0-9]+}},"args":{"function":"diamond"}},
+; CHECK-NEXT: {"name":"computeDependencies",{{.*}}"args":{"function":"diamond"}},
+; CHECK-NEXT: {"name":"insertRegions",{{.*}}"args":{"function":"diamond"}},
+; CHECK-NEXT: {"name":"splitTrueFalseEdges",{{.*}}"args":{"function":"diamond"}},
+; CHECK-NEXT: {"name":"graphForFunction",{{.*}}"args":{"function":"diamond"}},
+; CHECK-NEXT: {"name":"postDominators",{{.*}}"args":{"function":"quo\"te\\d"}},
+; CHECK: {"name":"graphForFunction",{{.*}}"args":{"function":"quo\"te\\d"}}{{$}}
+; CHECK-NEXT: {{^\]$}}
+define i32 @diamond(i1 %c) {
+entry:
+  br i1 %c, label %then, label %else
+
+then:
+  br label %join
+
+else:
+  br label %join
+
+join:
+  %r = phi i32 [ 1, %then ], [ 2, %else ]
+  ret i32 %r
+}
+
+define void @"quo\22te\5Cd"(i1 %c) {
+entry:
+  br i1 %c, label %then, label %exit
+
+then:
+  br label %exit
+
+exit:
+  ret void
+}
@@ -0,0 +1,35 @@
+; RUN: opt %loadintraproc -unswitch-candidates -analyze < %s | FileCheck %s
+
+; A loop-invariant branch below the loop header, both of whose sides reach
+; the latches. The latches control the header and the branch itself, so the
+; walk from either side must stop at the branch and the header rather than
+; go around the loop: only %body and %other are dropped by one copy each.
+
+; CHECK-LABEL: Unswitching candidates for 'inner':
+; CHECK-NEXT: loop at depth 1 with header %header: 1 candidates
+; CHECK-NEXT: %check: controls 3 blocks (9 instructions), benefit 6, growth 4
+define void @inner(i1 %inv, i32 %n) {
+entry:
+  br label %header
+
+header:
+  %i = phi i32 [ 0, %entry ], [ %i.next, %body ], [ %i.next, %other ]
+  %i.next = add i32 %i, 1
+  br label %check
+
+check:
+  br i1 %inv, label %body, label %other
+
+body:
+  %x = add i32 %i, 2
+  %c = icmp eq i32 %x, %n
+  br i1 %c, label %exit, label %header
+
+other:
+  %y = mul i32 %i, 3
+  %d = icmp eq i32 %y, %n
+  br i1 %d, label %exit, label %header
+
+exit:
+  ret void
+}
@@ -0,0 +1,415 @@
+//===- cdg-bench/cdg-bench.cpp ----------------------------------*- C++ -*-===//
+//
+//                      Static Program Analysis for LLVM
+//
+// This file is distributed under a Modified BSD License (see LICENSE.TXT).
+//
+//===----------------------------------------------------------------------===//
+//
+// cdg-bench builds the control dependence graph of every function in a corpus
+// of bitcode and textual IR files and reports, as CSV, how long each took,
+// how much memory it kept and how large it is, followed by percentiles over
+// the whole corpus. The -cdg-* flags of the library select the options.
+// With -stress-blocks it also builds synthetic functions of the given size
+// whose if-statements and loops nest as deeply as possible; with -scaling it
+// builds them at 10^4, 10^5 and 10^6 blocks and reports how time and peak
+// memory grow.
+//
+//===----------------------------------------------------------------------===//
+
+#include "IntraProc/ControlDependenceGraph.h"
+
+#include "llvm/Config/llvm-config.h"
+#include "llvm/InitializePasses.h"
+#include "llvm/IR/DerivedTypes.h"
+#include "llvm/IR/Instructions.h"
+#include "llvm/IR/LLVMContext.h"
+#include "llvm/IR/Module.h"
+#include "llvm/IRReader/IRReader.h"
+#include "llvm/PassManager.h"
+#include "llvm/Support/CommandLine.h"
+#include "llvm/Support/FileSystem.h"
+#include "llvm/Support/ManagedStatic.h"
+#include "llvm/Support/Path.h"
+#include "llvm/Support/PrettyStackTrace.h"
+#include "llvm/Support/Process.h"
+#include "llvm/Support/Signals.h"
+#include "llvm/Support/SourceMgr.h"
+#include "llvm/Support/TimeValue.h"
+#include "llvm/Support/raw_ostream.h"
+
+#include <algorithm>
+#include <string>
+#include <vector>
+
+#ifdef LLVM_ON_UNIX
+#include <sys/resource.h>
+#endif
+
+using namespace llvm;
+
+static cl::list<std::string>
+InputPaths(cl::Positional, cl::ZeroOrMore,
+           cl::desc("<directories or .bc/.ll files>"));
+
+static cl::opt<std::string>
+OutputFilename("o", cl::init("-"), cl::value_desc("filename"),
+               cl::desc("Write the per-function CSV to <filename>"));
+
+static cl::opt<std::string>
+SummaryFilename("summary", cl::init("-"), cl::value_desc("filename"),
+                cl::desc("Write the corpus percentiles CSV to <filename> "
+                         "(default: after the per-function CSV)"));
+
+static cl::opt<unsigned>
+Repeat("repeat", cl::init(1),
+       cl::desc("Build every graph this many times and keep the fastest"));
+
+static cl::opt<unsigned>
+StressBlocks("stress-blocks", cl::init(0), cl::value_desc("N"),
+             cl::desc("Also build graphs for synthetic functions of about N "
+                      "blocks with deeply nested ifs and loops"));
+
+static cl::opt<std::string>
+StressOutput("stress-output", cl::value_desc("filename"),
+             cl::desc("Write the synthetic functions of -stress-blocks to "
+                      "<filename> as textual IR"));
+
+static cl::opt<bool>
+Scaling("scaling",
+        cl::desc("Instead of a corpus, build synthetic functions of 10^4, "
+                 "10^5 and 10^6 blocks and report the time and peak memory "
+                 "of each"));
+
+namespace {
+
+struct Sample {
+  uint64_t TimeUS;
+  uint64_t Memory;
+  unsigned Blocks;
+  unsigned Nodes;
+  unsigned Regions;
+  unsigned Edges;
+  unsigned Approximate;
+  const char *Tier;
+};
+
+// The measurements of the whole corpus, for the percentiles.
+struct Corpus {
+  std::vector<uint64_t> Times, Memory, Nodes, Regions;
+  unsigned Approximate;
+
+  Corpus() : Approximate(0) {}
+};
+
+} // end anonymous namespace
+
+static bool isIRFile(StringRef Path) {
+  StringRef Ext = sys::path::extension(Path);
+  return Ext == ".bc" || Ext == ".ll";
+}
+
+// Collect the IR files named by Path, or found below it if it is a directory.
+static void collectFiles(const std::string &Path, std::vector<std::string> &Files) {
+  bool IsDir = false;
+  if (sys::fs::is_directory(Path, IsDir) || !IsDir) {
+    Files.push_back(Path);
+    return;
+  }
+  std::error_code EC;
+  for (sys::fs::recursive_directory_iterator I(Path, EC), E; I != E && !EC;
+       I.increment(EC))
+    if (isIRFile(I->path()))
+      Files.push_back(I->path());
+  if (EC)
+    errs() << "cdg-bench: " << Path << ": " << EC.message() << "\n";
+}
+
+// Build the graph of F Repeat times. The time and memory reported are those
+// of the fastest run.
+static Sample measure(Function &F, ControlDependenceGraphBase &G,
+                      PostDominatorBuilder &pdb, LazyValueInfo *LVI, LoopInfo *LI) {
+  Sample S;
+  S.TimeUS = ~0ULL;
+  S.Memory = 0;
+  for (unsigned r = 0; r != Repeat; ++r) {
+    G.releaseMemory();
+    size_t Before = sys::Process::GetMallocUsage();
+    sys::TimeValue Start = sys::TimeValue::now();
+    G.graphForFunction(F,pdb,LVI,LI);
+    uint64_t Elapsed = (sys::TimeValue::now() - Start).usec();
+    size_t After = sys::Process::GetMallocUsage();
+    if (Elapsed < S.TimeUS) {
+      S.TimeUS = Elapsed;
+      S.Memory = After > Before ? After - Before : 0;
+    }
+  }
+
+  S.Approximate = G.isApproximate();
+  switch (G.getTier()) {
+  case ControlDependenceGraphBase::TrivialTier: S.Tier = "trivial"; break;
+  case ControlDependenceGraphBase::SmallTier:   S.Tier = "small"; break;
+  case ControlDependenceGraphBase::FullTier:    S.Tier = "full"; break;
+  }
+  S.Blocks = F.size();
+  S.Nodes = G.getNumNodes();
+  S.Regions = 0;
+  S.Edges = 0;
+  for (unsigned i = 0; i != S.Nodes; ++i) {
+    const ControlDependenceNode *N = G.getNodeByID(i);
+    if (N->isRegion())
+      ++S.Regions;
+    S.Edges += N->getNumChildren();
+  }
+  G.releaseMemory();
+  return S;
+}
+
+namespace {
+
+// Measures every function of one file. Running as a pass lets the pass
+// manager supply the LazyValueInfo and LoopInfo that -cdg-prune-with-lvi,
+// -cdg-collapse-loops and the budgets need.
+struct BenchPass : public FunctionPass {
+  static char ID;
+  BenchPass(const std::string &File, raw_ostream &Out, Corpus &C)
+    : FunctionPass(ID), File(File), Out(Out), C(C) {
+    G.setOptions(ControlDependenceOptions::fromCommandLine());
+  }
+
+  virtual void getAnalysisUsage(AnalysisUsage &AU) const {
+    ControlDependenceGraph::addRequiredAnalyses(AU);
+    AU.setPreservesAll();
+  }
+
+  virtual bool runOnFunction(Function &F) {
+    LazyValueInfo *LVI;
+    LoopInfo *LI;
+    ControlDependenceGraph::getRequiredAnalyses(*this, LVI, LI);
+    Sample S = measure(F, G, pdb, LVI, LI);
+    Out << File << ',' << F.getName() << ',' << S.Blocks << ','
+        << S.Nodes << ',' << S.Regions << ',' << S.Edges << ','
+        << S.Approximate << ',' << S.Tier << ',' << S.TimeUS << ',' << S.Memory << '\n';
+    C.Times.push_back(S.TimeUS);
+    C.Memory.push_back(S.Memory);
+    C.Nodes.push_back(S.Nodes);
+    C.Regions.push_back(S.Regions);
+    C.Approximate += S.Approximate;
+    return false;
+  }
+
+private:
+  std::string File;
+  raw_ostream &Out;
+  Corpus &C;
+  ControlDependenceGraphBase G;
+  PostDominatorBuilder pdb;
+};
+
+} // end anonymous namespace
+
+char BenchPass::ID = 0;
+
+// Nearest-rank percentile of the sorted values V.
+static uint64_t percentile(const std::vector<uint64_t> &V, unsigned P) {
+  if (V.empty())
+    return 0;
+  size_t Rank = (V.size() * P + 99) / 100;
+  return V[Rank ? Rank - 1 : 0];
+}
+
+static void summarize(raw_ostream &OS, const char *Metric, std::vector<uint64_t> V) {
+  std::sort(V.begin(), V.end());
+  uint64_t Total = 0;
+  for (unsigned i = 0, e = V.size(); i != e; ++i)
+    Total += V[i];
+  OS << Metric << ',' << V.size() << ',' << Total << ','
+     << (V.empty() ? 0 : V.front()) << ',' << percentile(V, 50) << ','
+     << percentile(V, 90) << ',' << percentile(V, 99) << ','
+     << (V.empty() ? 0 : V.back()) << '\n';
+}
+
+static Function *createStressFunction(Module &M, const char *Name) {
+  LLVMContext &Ctx = M.getContext();
+  std::vector<Type *> Params(1, Type::getInt1Ty(Ctx));
+  FunctionType *FT = FunctionType::get(Type::getVoidTy(Ctx), Params, false);
+  return Function::Create(FT, GlobalValue::ExternalLinkage, Name, &M);
+}
+
+// Nest if-statements Depth deep: the I-th branches into the (I+1)-th or
+// straight to its join block.
+static void buildNestedIfs(Module &M, unsigned Depth) {
+  Function *F = createStressFunction(M, "nested_ifs");
+  LLVMContext &Ctx = M.getContext();
+  Value *C = F->arg_begin();
+  std::vector<BasicBlock *> Ifs(Depth), Joins(Depth);
+  for (unsigned i = 0; i != Depth; ++i)
+    Ifs[i] = BasicBlock::Create(Ctx, "", F);
+  for (unsigned i = Depth; i-- != 0; )
+    Joins[i] = BasicBlock::Create(Ctx, "", F);
+  for (unsigned i = 0; i != Depth; ++i) {
+    if (i + 1 != Depth)
+      BranchInst::Create(Ifs[i+1], Joins[i], C, Ifs[i]);
+    else
+      BranchInst::Create(Joins[i], Ifs[i]);
+    if (i != 0)
+      BranchInst::Create(Joins[i-1], Joins[i]);
+    else
+      ReturnInst::Create(Ctx, Joins[i]);
+  }
+}
+
+// Nest loops Depth deep behind an entry block, which may not be a loop
+// header: the I-th header enters the (I+1)-th loop or skips to its own
+// latch, which either repeats the loop or leaves it.
+static void buildNestedLoops(Module &M, unsigned Depth) {
+  Function *F = createStressFunction(M, "nested_loops");
+  LLVMContext &Ctx = M.getContext();
+  Value *C = F->arg_begin();
+  BasicBlock *Entry = BasicBlock::Create(Ctx, "", F);
+  std::vector<BasicBlock *> Headers(Depth), Latches(Depth);
+  for (unsigned i = 0; i != Depth; ++i)
+    Headers[i] = BasicBlock::Create(Ctx, "", F);
+  for (unsigned i = Depth; i-- != 0; )
+    Latches[i] = BasicBlock::Create(Ctx, "", F);
+  BasicBlock *Exit = BasicBlock::Create(Ctx, "", F);
+  ReturnInst::Create(Ctx, Exit);
+  BranchInst::Create(Headers[0], Entry);
+  for (unsigned i = 0; i != Depth; ++i) {
+    if (i + 1 != Depth)
+      BranchInst::Create(Headers[i+1], Latches[i], C, Headers[i]);
+    else
+      BranchInst::Create(Latches[i], Headers[i]);
+    BranchInst::Create(Headers[i], i ? Latches[i-1] : Exit, C, Latches[i]);
+  }
+}
+
+// The peak resident set size of the process so far, or 0 where it cannot be
+// read.
+static uint64_t getPeakRSS() {
+#ifdef LLVM_ON_UNIX
+  struct rusage RU;
+  if (getrusage(RUSAGE_SELF, &RU) == 0)
+#ifdef __APPLE__
+    return RU.ru_maxrss;
+#else
+    return uint64_t(RU.ru_maxrss) * 1024;
+#endif
+#endif
+  return 0;
+}
+
+// Build the nested ifs and loops of 10^4, 10^5 and 10^6 blocks, smallest
+// first, and write the construction time and the peak resident memory after
+// each build. The peak only grows, so with sizes in increasing order each row
+// reports the peak of its own build.
+static void runScaling(raw_ostream &Out) {
+  Out << "function,blocks,nodes,time_us,peak_rss_bytes\n";
+  ControlDependenceGraphBase G;
+  G.setOptions(ControlDependenceOptions::fromCommandLine());
+  for (unsigned Blocks = 10000; Blocks <= 1000000; Blocks *= 10) {
+    LLVMContext Context;
+    Module M("scaling", Context);
+    buildNestedIfs(M, Blocks / 2);
+    buildNestedLoops(M, Blocks / 2);
+    for (Module::iterator F = M.begin(), E = M.end(); F != E; ++F) {
+      PostDominatorBuilder pdb;
+      sys::TimeValue Start = sys::TimeValue::now();
+      G.graphForFunction(*F,pdb);
+      uint64_t Elapsed = (sys::TimeValue::now() - Start).usec();
+      Out << F->getName() << ',' << F->size() << ',' << G.getNumNodes() << ','
+          << Elapsed << ',' << getPeakRSS() << '\n';
+      G.releaseMemory();
+    }
+  }
+}
+
+static raw_ostream *openOutput(const std::string &Name) {
+  if (Name == "-")
+    return &outs();
+  std::string Err;
+  raw_fd_ostream *OS = new raw_fd_ostream(Name.c_str(), Err, sys::fs::F_Text);
+  if (!Err.empty()) {
+    errs() << "cdg-bench: " << Err << "\n";
+    exit(1);
+  }
+  return OS;
+}
+
+int main(int argc, char **argv) {
+  sys::PrintStackTraceOnErrorSignal();
+  PrettyStackTraceProgram X(argc, argv);
+  llvm_shutdown_obj Y;
+  cl::ParseCommandLineOptions(argc, argv, "control dependence graph benchmark\n");
+
+  if (Scaling) {
+    raw_ostream *Out = openOutput(OutputFilename);
+    runScaling(*Out);
+    if (Out != &outs())
+      delete Out;
+    return 0;
+  }
+
+  std::vector<std::string> Files;
+  for (unsigned i = 0, e = InputPaths.size(); i != e; ++i)
+    collectFiles(InputPaths[i], Files);
+  std::sort(Files.begin(), Files.end());
+
+  raw_ostream *Out = openOutput(OutputFilename);
+  *Out << "file,function,blocks,nodes,regions,edges,approximate,tier,time_us,memory_bytes\n";
+
+  PassRegistry &Registry = *PassRegistry::getPassRegistry();
+  initializeCore(Registry);
+  initializeAnalysis(Registry);
+  initializeTarget(Registry);
+
+  Corpus C;
+  for (unsigned i = 0, e = Files.size(); i != e; ++i) {
+    LLVMContext Context;
+    SMDiagnostic Err;
+    Module *M = ParseIRFile(Files[i], Err, Context);
+    if (!M) {
+      Err.print(argv[0], errs());
+      continue;
+    }
+    PassManager PM;
+    PM.add(new BenchPass(Files[i], *Out, C));
+    PM.run(*M);
+    delete M;
+  }
+
+  if (StressBlocks) {
+    LLVMContext Context;
+    Module M("stress", Context);
+    unsigned Depth = std::max(StressBlocks / 2, 1U);
+    buildNestedIfs(M, Depth);
+    buildNestedLoops(M, Depth);
+    if (!StressOutput.empty()) {
+      raw_ostream *IR = openOutput(StressOutput);
+      M.print(*IR, NULL);
+      if (IR != &outs())
+        delete IR;
+    }
+    PassManager PM;
+    PM.add(new BenchPass("stress", *Out, C));
+    PM.run(M);
+  }
+
+  raw_ostream *Summary = Out;
+  if (SummaryFilename != "-")
+    Summary = openOutput(SummaryFilename);
+  else
+    *Out << '\n';
+  *Summary << "metric,count,total,min,p50,p90,p99,max\n";
+  summarize(*Summary, "time_us", C.Times);
+  summarize(*Summary, "memory_bytes", C.Memory);
+  summarize(*Summary, "nodes", C.Nodes);
+  summarize(*Summary, "regions", C.Regions);
+  *Summary << "approximate," << C.Times.size() << ',' << C.Approximate << ",,,,,\n";
+
+  if (Summary != Out && Summary != &outs())
+    delete Summary;
+  if (Out != &outs())
+    delete Out;
+  return 0;
+}
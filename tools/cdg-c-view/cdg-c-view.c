@@ -0,0 +1,114 @@
+/*===- cdg-c-view.c - Print graphs through the C interface ------*- C -*-===*\
+|*                                                                            *|
+|*                      Static Program Analysis for LLVM                      *|
+|*                                                                            *|
+|* This file is distributed under a Modified BSD License (see LICENSE.TXT).   *|
+|*                                                                            *|
+|*===----------------------------------------------------------------------===*|
+|*                                                                            *|
+|* This program reads a module from standard input, builds the control        *|
+|* dependence graph of every function through the C interface alone, and      *|
+|* prints the flat view of each, so that the view can be tested without a C++ *|
+|* client. It also checks the lookups against the view, and reports any       *|
+|* disagreement on standard error.                                            *|
+|*                                                                            *|
+\*===----------------------------------------------------------------------===*/
+
+#include "IntraProc-c/ControlDependenceGraph.h"
+
+#include "llvm-c/IRReader.h"
+
+#include <stdio.h>
+#include <string.h>
+
+static const char *const EdgePrefix[] = { "T", "F", "" };
+
+static int printGraph(LLVMValueRef Fn, unsigned Flags) {
+  LLVMControlDependenceGraphRef G;
+  LLVMCDGraphView View;
+  LLVMBasicBlockRef BB;
+  uint32_t i, e;
+  int errors = 0;
+
+  G = LLVMCreateControlDependenceGraph(Fn, Flags, 0, 0);
+  LLVMGetControlDependenceGraphView(G, &View);
+  printf("Graph of '%s'%s: %u nodes, %u edges\n", LLVMGetValueName(Fn),
+         LLVMIsControlDependenceGraphApproximate(G) ? " (approximate)" : "",
+         View.NumNodes, View.NumEdges);
+
+  for (i = 0; i != View.NumNodes; ++i) {
+    LLVMBasicBlockRef NodeBB = LLVMGetControlDependenceNodeBlock(G, i);
+    printf("  %u", i);
+    if (View.NodeKinds[i] == LLVMCDNodeBlock) {
+      printf(" block %d %%%s", View.BlockIndices[i],
+             LLVMGetValueName(LLVMBasicBlockAsValue(NodeBB)));
+      if (LLVMGetControlDependenceNode(G, NodeBB) != (int32_t)i) {
+        fprintf(stderr, "node %u: block maps to another node\n", i);
+        ++errors;
+      }
+    } else {
+      printf(i == 0 ? " root" : " region");
+      if (NodeBB) {
+        fprintf(stderr, "node %u: region has a block\n", i);
+        ++errors;
+      }
+    }
+    printf(":");
+    for (e = View.EdgeOffsets[i]; e != View.EdgeOffsets[i+1]; ++e)
+      printf(" %s%u", EdgePrefix[View.EdgeLabels[e]], View.EdgeTargets[e]);
+    if (View.Hashes)
+      printf(" hash %016llx", (unsigned long long)View.Hashes[i]);
+    printf("\n");
+  }
+  if (View.EdgeOffsets[View.NumNodes] != View.NumEdges) {
+    fprintf(stderr, "edge offsets do not cover the edges\n");
+    ++errors;
+  }
+  if (LLVMGetControlDependenceNodeBlock(G, View.NumNodes)) {
+    fprintf(stderr, "node %u is out of range but has a block\n", View.NumNodes);
+    ++errors;
+  }
+
+  for (BB = LLVMGetFirstBasicBlock(Fn); BB; BB = LLVMGetNextBasicBlock(BB))
+    printf("  %%%s in region %u\n", LLVMGetValueName(LLVMBasicBlockAsValue(BB)),
+           LLVMGetEnclosingControlDependenceRegion(G, BB));
+
+  LLVMDisposeControlDependenceGraph(G);
+  return errors;
+}
+
+int main(int argc, char **argv) {
+  LLVMContextRef Context = LLVMContextCreate();
+  LLVMMemoryBufferRef Buffer;
+  LLVMModuleRef M;
+  LLVMValueRef Fn;
+  unsigned Flags = 0;
+  char *Message;
+  int i, errors = 0;
+
+  for (i = 1; i != argc; ++i) {
+    if (!strcmp(argv[i], "-hash")) {
+      Flags |= LLVMCDHashRegions;
+    } else if (!strcmp(argv[i], "-prune")) {
+      Flags |= LLVMCDPruneInfeasibleEdges;
+    } else {
+      fprintf(stderr, "usage: %s [-hash] [-prune] < module\n", argv[0]);
+      return 2;
+    }
+  }
+
+  if (LLVMCreateMemoryBufferWithSTDIN(&Buffer, &Message) ||
+      LLVMParseIRInContext(Context, Buffer, &M, &Message)) {
+    fprintf(stderr, "%s: %s\n", argv[0], Message);
+    LLVMDisposeMessage(Message);
+    return 1;
+  }
+
+  for (Fn = LLVMGetFirstFunction(M); Fn; Fn = LLVMGetNextFunction(Fn))
+    if (!LLVMIsDeclaration(Fn))
+      errors += printGraph(Fn, Flags);
+
+  LLVMDisposeModule(M);
+  LLVMContextDispose(Context);
+  return errors != 0;
+}
@@ -0,0 +1,136 @@
+//===- cdg-llc/cdg-llc.cpp --------------------------------------*- C++ -*-===//
+//
+//                      Static Program Analysis for LLVM
+//
+// This file is distributed under a Modified BSD License (see LICENSE.TXT).
+//
+//===----------------------------------------------------------------------===//
+//
+// cdg-llc runs the code generator of a target over a module, as llc does, and
+// prints the MachineControlDependenceGraph of every function once its machine
+// code is final. The assembly itself is discarded.
+//
+//===----------------------------------------------------------------------===//
+
+#include "IntraProc/MachineControlDependenceGraph.h"
+
+#include "llvm/ADT/Triple.h"
+#include "llvm/CodeGen/MachineFunctionPass.h"
+#include "llvm/InitializePasses.h"
+#include "llvm/IR/DataLayout.h"
+#include "llvm/IR/LLVMContext.h"
+#include "llvm/IR/Module.h"
+#include "llvm/IRReader/IRReader.h"
+#include "llvm/PassManager.h"
+#include "llvm/Support/CommandLine.h"
+#include "llvm/Support/FormattedStream.h"
+#include "llvm/Support/Host.h"
+#include "llvm/Support/ManagedStatic.h"
+#include "llvm/Support/PrettyStackTrace.h"
+#include "llvm/Support/Signals.h"
+#include "llvm/Support/SourceMgr.h"
+#include "llvm/Support/TargetRegistry.h"
+#include "llvm/Support/TargetSelect.h"
+#include "llvm/Support/raw_ostream.h"
+#include "llvm/Target/TargetLibraryInfo.h"
+#include "llvm/Target/TargetMachine.h"
+
+#include <string>
+
+using namespace llvm;
+
+static cl::opt<std::string>
+InputFilename(cl::Positional, cl::init("-"),
+              cl::desc("<input bitcode or IR>"));
+
+static cl::opt<std::string>
+TargetTriple("mtriple", cl::desc("Override the target triple of the module"));
+
+static cl::opt<bool>
+Optimize("O", cl::desc("Generate code with the default optimization level "
+                       "instead of none"));
+
+namespace {
+  // Prints the machine graph of each function after the code generator is
+  // done with it.
+  struct MachineGraphPrinter : public MachineFunctionPass {
+    static char ID;
+
+    MachineGraphPrinter() : MachineFunctionPass(ID) {}
+
+    virtual void getAnalysisUsage(AnalysisUsage &AU) const {
+      AU.addRequired<MachineControlDependenceGraph>();
+      AU.setPreservesAll();
+      MachineFunctionPass::getAnalysisUsage(AU);
+    }
+
+    virtual bool runOnMachineFunction(MachineFunction &MF) {
+      outs() << "Machine control dependence graph for '" << MF.getName() << "':\n";
+      getAnalysis<MachineControlDependenceGraph>().print(outs(), NULL);
+      return false;
+    }
+  };
+}
+
+char MachineGraphPrinter::ID = 0;
+
+int main(int argc, char **argv) {
+  sys::PrintStackTraceOnErrorSignal();
+  PrettyStackTraceProgram X(argc, argv);
+  llvm_shutdown_obj Y;
+
+  InitializeAllTargets();
+  InitializeAllTargetMCs();
+  InitializeAllAsmPrinters();
+
+  PassRegistry &Registry = *PassRegistry::getPassRegistry();
+  initializeCore(Registry);
+  initializeCodeGen(Registry);
+  initializeAnalysis(Registry);
+  initializeTarget(Registry);
+
+  cl::ParseCommandLineOptions(argc, argv, "machine control dependence graphs\n");
+
+  LLVMContext Context;
+  SMDiagnostic Err;
+  Module *M = ParseIRFile(InputFilename, Err, Context);
+  if (!M) {
+    Err.print(argv[0], errs());
+    return 1;
+  }
+
+  Triple TheTriple(TargetTriple.empty() ? M->getTargetTriple() : TargetTriple);
+  if (TheTriple.getTriple().empty())
+    TheTriple.setTriple(sys::getDefaultTargetTriple());
+  M->setTargetTriple(TheTriple.getTriple());
+
+  std::string Error;
+  const Target *T = TargetRegistry::lookupTarget(TheTriple.getTriple(), Error);
+  if (!T) {
+    errs() << argv[0] << ": " << Error << "\n";
+    return 1;
+  }
+  TargetMachine *TM =
+    T->createTargetMachine(TheTriple.getTriple(), "", "", TargetOptions(),
+                           Reloc::Default, CodeModel::Default,
+                           Optimize ? CodeGenOpt::Default : CodeGenOpt::None);
+
+  PassManager PM;
+  PM.add(new TargetLibraryInfo(TheTriple));
+  TM->addAnalysisPasses(PM);
+  if (const DataLayout *DL = TM->getDataLayout())
+    M->setDataLayout(DL);
+  PM.add(new DataLayoutPass(M));
+
+  formatted_raw_ostream FOS(nulls());
+  if (TM->addPassesToEmitFile(PM, FOS, TargetMachine::CGFT_AssemblyFile)) {
+    errs() << argv[0] << ": target does not support generation of this file type\n";
+    return 1;
+  }
+  PM.add(new MachineGraphPrinter());
+  PM.run(*M);
+
+  delete TM;
+  delete M;
+  return 0;
+}